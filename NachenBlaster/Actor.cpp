@@ -1,54 +1,43 @@
 #include "Actor.h"
+#include "CollisionKernel.h"
 
 //////////////////////////////////////////////////////////////////////////////////
 // HELPER FUNCTIONS 
 //////////////////////////////////////////////////////////////////////////////////
 
-double starSize()
+ActorKind actorKind(int imageID, int dir)
 {
-	double temp = randInt(5, 50);
-	temp /= 100.0;
-	return temp;
-}
-double euclidianDistance(double x1, double y1, double x2, double y2)
-{
-	double tempX = x2 - x1;
-	double tempY = y2 - y1;
-	return sqrt((tempX * tempX) + (tempY * tempY));
+	switch (imageID)
+	{
+	case IID_CABBAGE:		 return KIND_CABBAGE;
+	case IID_TORPEDO:		 return (dir == 0 ? KIND_FRIENDLY_TORPEDO : KIND_ENEMY_TORPEDO);
+	case IID_TURNIP:		 return KIND_TURNIP;
+	case IID_REPAIR_GOODIE:	 return KIND_REPAIR_GOODIE;
+	case IID_LIFE_GOODIE:	 return KIND_LIFE_GOODIE;
+	case IID_TORPEDO_GOODIE: return KIND_TORPEDO_GOODIE;
+	case IID_SMALLGON:		 return KIND_SMALLGON;
+	case IID_SMOREGON:		 return KIND_SMOREGON;
+	case IID_SNAGGLEGON:	 return KIND_SNAGGLEGON;
+	default:				 return KIND_NACHENBLASTER;
+	}
 }
 bool isAlien(const Actor* target)
 {
-	if (target->getActorID() == IID_SMALLGON ||
-		target->getActorID() == IID_SMOREGON ||
-		target->getActorID() == IID_SNAGGLEGON)
-		return true;
-	return false;
+	return target->getKind() >= FIRST_ALIEN_KIND && target->getKind() <= LAST_ALIEN_KIND;
 }
 bool isFriendlyProjectile(const Actor* target)
 {
-	if (target->getActorID() == IID_CABBAGE)	// cabbages are friendly 
-		return true;
-	if (target->getActorID() == IID_TORPEDO &&	// torpedoes moving right are friendly
-		target->getDirection() == 0)
-		return true;
-	return false;
+	// cabbages and torpedoes moving right are friendly
+	return target->getKind() >= FIRST_FRIENDLY_PROJECTILE_KIND && target->getKind() < FIRST_ENEMY_PROJECTILE_KIND;
 }
 bool isEnemyProjectile(const Actor* target)
 {
-	if (target->getActorID() == IID_TURNIP)	// turnips are from enemies
-		return true;
-	if (target->getActorID() == IID_TORPEDO &&	// torpedoes moving left are from enemies
-		target->getDirection() == 180)
-		return true;
-	return false;
+	// turnips and torpedoes moving left are from enemies
+	return target->getKind() >= FIRST_ENEMY_PROJECTILE_KIND && target->getKind() < FIRST_GOODIE_KIND;
 }
 bool isGoodie(const Actor* target)
 {
-	if (target->getActorID() == IID_REPAIR_GOODIE ||
-		target->getActorID() == IID_LIFE_GOODIE   ||
-		target->getActorID() == IID_TORPEDO_GOODIE )
-		return true;
-	return false;
+	return target->getKind() >= FIRST_GOODIE_KIND && target->getKind() < FIRST_ALIEN_KIND;
 }
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -57,47 +46,112 @@ bool isGoodie(const Actor* target)
 
 Actor::Actor(const int& imageID, const double& startX, const double& startY, 
 			 StudentWorld* world, Direction dir, double size, unsigned int depth)
-:GraphObject(imageID, startX, startY, dir, size, depth)
+:GraphObject(world->getGraphObjects(), imageID, startX, startY, dir, size, depth)
 {
-	m_alive = true;
 	m_actorID = imageID;
+	m_kind = actorKind(imageID, dir);
 	m_scorePoints = 0;
 	m_world = world;
-	m_health = 5;
+	// take a slot in the world's table; it holds our hot data from here on
+	m_handle = m_world->getActorTable().add(this, m_kind);
+	ActorHotData& data = hot();
+	data.x[m_handle.index] = startX;
+	data.y[m_handle.index] = startY;
+	data.radius[m_handle.index] = getRadius();
+	data.health[m_handle.index] = 5;
+}
+Actor::~Actor()
+{
+	m_world->getActorTable().remove(m_handle);	// no-op if the world already let go of us
 }
 void Actor::collide(Actor& other)	// if there is a collision, look at the proper collisionProperties
 {
-	if (euclidianDistance(getX(), getY(), other.getX(), other.getY()) < .75 * (getRadius() + other.getRadius()))
-	{	
-		if (other.isAlive() && isAlive())	// make sure both things are alive before colliding
-			collisionProperties(other);
+	const ActorHotData& data = hot();
+	unsigned int me = m_handle.index, them = other.m_handle.index;
+	if (overlaps(data.x[me], data.y[me], data.radius[me], data.x[them], data.y[them], data.radius[them]))
+		collideOverlapping(other);
+}
+void Actor::collideOverlapping(Actor& other)
+{
+	const ActorHotData& data = hot();
+	if (data.alive[other.m_handle.index] && data.alive[m_handle.index])	// make sure both things are alive before colliding
+		collisionProperties(other);
+}
+void Actor::moveTo(double x, double y)
+{
+	GraphObject::moveTo(x, y);
+	hot().x[m_handle.index] = x;
+	hot().y[m_handle.index] = y;
+}
+void Actor::setSize(double size)
+{
+	GraphObject::setSize(size);
+	hot().radius[m_handle.index] = getRadius();
+}
+void Actor::warpTo(double x, double y)
+{
+	GraphObject::warpTo(x, y);
+	hot().x[m_handle.index] = x;
+	hot().y[m_handle.index] = y;
+}
+void Actor::saveState(SnapshotWriter& out) const
+{
+	const ActorHotData& data = hot();
+	out.write(data.x[m_handle.index]);
+	out.write(data.y[m_handle.index]);
+	out.write(GraphObject::getDirection());
+	out.write(getSize());
+	out.write(data.health[m_handle.index]);
+	out.write(data.alive[m_handle.index]);
+	out.write(m_scorePoints);
+}
+void Actor::loadState(SnapshotReader& in)
+{
+	double x = in.read<double>();
+	double y = in.read<double>();
+	int dir = in.read<int>();
+	double size = in.read<double>();
+	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(size))	// NaN would poison the collision grid
+		in.fail();
+	else
+	{
+		warpTo(x, y);
+		setSize(size);
 	}
+	GraphObject::setDirection(dir);
+	hot().health[m_handle.index] = in.read<int>();
+	hot().alive[m_handle.index] = in.read<unsigned char>();
+	m_scorePoints = in.read<int>();
 }
 
 	// helper function definitions
 void Actor::setHealth(int amt)
 {
-	m_health = amt;
+	hot().health[m_handle.index] = amt;
 }
 int  Actor::getHealth() const
 {
-	return m_health;
+	return hot().health[m_handle.index];
 }
 void Actor::takeDamage(int amt)
 {
-	m_health -= amt;
+	hot().health[m_handle.index] -= amt;
 }
 int  Actor::getActorID() const
 {
 	return m_actorID;
 }   // get an actor's ID
+ActorKind Actor::getKind() const
+{
+	return m_kind;
+}
 void Actor::kill()
 {
-	m_alive = false;
+	hot().alive[m_handle.index] = false;
 }			// set an actor's state to dead
 bool Actor::isAlive() const
 {
-	return m_alive;
+	return hot().alive[m_handle.index] != 0;
 }		// check if an actor is alive (true) or dead (false)
 void Actor::setScore(int amt)				// set an actors points scoring mechanism to true
 {
@@ -107,55 +161,17 @@ int  Actor::getScore() const
 {
 	return m_scorePoints;
 }
-inline StudentWorld* Actor::getWorld() const
-{
-	return m_world;
-}
-
-//////////////////////////////////////////////////////////////////////////////////
-// STAR IMPLEMENTATION
-//////////////////////////////////////////////////////////////////////////////////
-
-Star::Star(double startY, StudentWorld* world)
-	:Actor(IID_STAR, VIEW_WIDTH-1, startY, world, 0, starSize(), 3)
-{
-}
-
-Star::Star(double startX, double startY, StudentWorld* world)
-	:Actor(IID_STAR, startX, startY, world, 0, starSize(), 3)
+ActorHandle Actor::getHandle() const
 {
+	return m_handle;
 }
-
-void Star::doSomething()	// stars move left 1 pixel/tick and die once they fall off screen
-{
-	if (getX() <= 0)
-	{
-		kill();
-	}
-	else
-		moveTo(getX() - 1, getY());
-}
-
-//////////////////////////////////////////////////////////////////////////////////
-// EXPLOSION IMPLEMENTATION
-//////////////////////////////////////////////////////////////////////////////////
-
-Explosion::Explosion(double startX, double startY, StudentWorld* world)
-	:Actor(IID_EXPLOSION, startX, startY, world, 0, 1.0, 0)
+inline StudentWorld* Actor::getWorld() const
 {
-	const int EXPLOSION_LENGTH = 3;
-	m_lifeTime = EXPLOSION_LENGTH;
+	return m_world;
 }
-
-void Explosion::doSomething()
+inline ActorHotData& Actor::hot() const
 {
-	if (m_lifeTime <= 0)	
-		kill();
-	else
-	{
-		setSize(getSize() * 1.5);
-		m_lifeTime--;
-	}
+	return m_world->getActorTable().hot();
 }
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -174,11 +190,11 @@ void NachenBlaster::doSomething()
 		return;
 	if (m_cabbageEnergy < 30)	// increase energy each tick
 		m_cabbageEnergy++;
-	int ch;
-	if (getWorld()->getKey(ch))	// if user pressed something, shoot and/or move
+	PlayerAction action;
+	if (getWorld()->getAction(action))	// if user did something, shoot and/or move
 	{
-		shootObject(ch);
-		moveShip(ch);
+		shootObject(action);
+		moveShip(action);
 	}
 }
 
@@ -187,64 +203,39 @@ void NachenBlaster::collisionProperties(Actor& other)	// when nachenblaster coll
 	// if we hit an object that does something, call its collide function.
 	if (isAlien(&other) || isEnemyProjectile(&other) || isGoodie(&other))
 			other.collide(*this);
-	// if we hit a star, explosion, or friendly projectile (AKA anything else), do nothing
+	// if we hit a friendly projectile (AKA anything else), do nothing
 }
 
 	// helper functions, inlined because we only make one user, so not memory intensive
-inline void NachenBlaster::shootObject(const int& ch)
+inline void NachenBlaster::shootObject(const PlayerAction& action)
 {
-	switch (ch)
-	{
-	case KEY_PRESS_SPACE:		// shoot a cabbage
+	if (action.fire && m_cabbageEnergy >= 5)	// shoot a cabbage, if there's enough energy
 	{
-		if (m_cabbageEnergy < 5) break;	// if not enough energy, don't do anything
 		m_cabbageEnergy -= 5;
-		Cabbage *temp = new Cabbage(getX() + 12, getY(), getWorld());
-		getWorld()->createActor(temp);
-		getWorld()->playSound(SOUND_PLAYER_SHOOT);
-		break;
+		getWorld()->spawnActor<Cabbage>(getX() + 12, getY(), getWorld());
+		getWorld()->getEvents().sound(SOUND_PLAYER_SHOOT);
 	}
-	case KEY_PRESS_TAB:		// shoot a torpedo
+	if (action.torpedo && m_nOfTorpedoes > 0)	// shoot a torpedo, if we have one
 	{
-		if (m_nOfTorpedoes <= 0)	break;// check that we have a torpedo
 		m_nOfTorpedoes--;
-		FTorpedoProjectile *temp = new FTorpedoProjectile(getX() + 12, getY(), getWorld(), 0);
-		getWorld()->createActor(temp);
-		getWorld()->playSound(SOUND_TORPEDO);
-		break;
-	}
+		getWorld()->spawnActor<FTorpedoProjectile>(getX() + 12, getY(), getWorld(), 0);
+		getWorld()->getEvents().sound(SOUND_TORPEDO);
 	}
 }
-inline void NachenBlaster::moveShip(const int& dir)
-{
-	// if U/D/L/R and if we can move, then move
-	switch (dir)
-	{
-	case KEY_PRESS_DOWN:
-	{
-		if (getY() >= 6)
-			moveTo(getX(), getY() - 6);
-		break;
-	}
-	case KEY_PRESS_UP:
-	{
-		if (getY() < VIEW_HEIGHT - 6)
-			moveTo(getX(), getY() + 6);
-		break;
-	}
-	case KEY_PRESS_LEFT:
-	{
-		if (getX() >= 6)
-			moveTo(getX() - 6, getY());
-		break;
-	}
-	case KEY_PRESS_RIGHT:
-	{
-		if (getX() < VIEW_WIDTH - 6)
-			moveTo(getX() + 6, getY());
-		break;
-	}
-	}
+inline void NachenBlaster::moveShip(const PlayerAction& action)
+{
+	// a step along each axis we were asked to move on, if there's room
+	double x = getX(), y = getY();
+	if (action.dy < 0 && y >= 6)
+		y -= 6;
+	else if (action.dy > 0 && y < VIEW_HEIGHT - 6)
+		y += 6;
+	if (action.dx < 0 && x >= 6)
+		x -= 6;
+	else if (action.dx > 0 && x < VIEW_WIDTH - 6)
+		x += 6;
+	if (x != getX() || y != getY())
+		moveTo(x, y);
 }
 void NachenBlaster::takeDamage(int amt)
 {
@@ -266,6 +257,18 @@ int NachenBlaster::getNOfTorpedoes() const
 {
 	return m_nOfTorpedoes;
 }
+void NachenBlaster::saveState(SnapshotWriter& out) const
+{
+	Actor::saveState(out);
+	out.write(m_cabbageEnergy);
+	out.write(m_nOfTorpedoes);
+}
+void NachenBlaster::loadState(SnapshotReader& in)
+{
+	Actor::loadState(in);
+	in.read(m_cabbageEnergy);
+	in.read(m_nOfTorpedoes);
+}
 
 //////////////////////////////////////////////////////////////////////////////////
 // PROJECTILE IMPLEMENTATION
@@ -400,8 +403,8 @@ void ExtraLife::collisionProperties(Actor& other)
 {
 	kill();
 	setScore(100);
-	getWorld()->playSound(SOUND_GOODIE);
-	getWorld()->incLives();
+	getWorld()->getEvents().sound(SOUND_GOODIE);
+	getWorld()->getEvents().extraLife();
 }
 
 /////////////////////////////////////////
@@ -416,7 +419,7 @@ void Repair::collisionProperties(Actor& other)
 {
 	kill();
 	setScore(100);
-	getWorld()->playSound(SOUND_GOODIE);
+	getWorld()->getEvents().sound(SOUND_GOODIE);
 	other.takeDamage(-10);
 }
 
@@ -432,8 +435,8 @@ void FTorpedoGoodie::collisionProperties(Actor& other)
 {
 	kill();
 	setScore(100);
-	getWorld()->playSound(SOUND_GOODIE);
-	getWorld()->getUser()->incTorpedoes(5);	// call NBs inc torpedoes function
+	getWorld()->getEvents().sound(SOUND_GOODIE);
+	getWorld()->getEvents().torpedoes(5);	// the user gets them at the end of the tick
 }
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -486,12 +489,12 @@ void Alien::doSomething()
 		if (getWorld()->getUser()->getY() >= (getY() - 4) &&	// if user is within 4 pixels of the
 			getWorld()->getUser()->getY() <= (getY() + 4))		// alien's height
 		{
-			if (randInt(1, (20 / getWorld()->getLevel()) + 5) == 1)	// then 1/20 chance of shooting
+			if (getWorld()->getAIRng().nextInt(1, (20 / getWorld()->getLevel()) + 5) == 1)	// then 1/20 chance of shooting
 			{
 				shoot();
 				return;
 			}
-			else if (randInt(1, (20 / getWorld()->getLevel()) + 5) == 1)
+			else if (getWorld()->getAIRng().nextInt(1, (20 / getWorld()->getLevel()) + 5) == 1)
 				ram();
 		}
 	// move the alien
@@ -503,13 +506,12 @@ void Alien::takeDamage(int amt)
 {
 	Actor::takeDamage(amt);
 	if (getHealth() > 0)		// don't check if dead here: check it in doSomething
-		getWorld()->playSound(SOUND_BLAST);
+		getWorld()->getEvents().sound(SOUND_BLAST);
 }
 void Alien::shoot()
 {
-	Turnip* temp = new Turnip(getX() - 14, getY(), getWorld());
-	getWorld()->createActor(temp);
-	getWorld()->playSound(SOUND_ALIEN_SHOOT);
+	getWorld()->spawnActor<Turnip>(getX() - 14, getY(), getWorld());
+	getWorld()->getEvents().sound(SOUND_ALIEN_SHOOT);
 }
 
 	// private functions
@@ -541,6 +543,25 @@ double Alien::getTravelSpeed() const
 {
 	return m_travelSpeed;
 }
+void Alien::saveState(SnapshotWriter& out) const
+{
+	Actor::saveState(out);
+	out.write(m_dir);
+	out.write(m_flightPlanLen);
+	out.write(m_travelSpeed);
+}
+void Alien::loadState(SnapshotReader& in)
+{
+	Actor::loadState(in);
+	in.read(m_dir);
+	in.read(m_flightPlanLen);
+	in.read(m_travelSpeed);
+	if (!std::isfinite(m_travelSpeed))	// it would carry straight into our position
+	{
+		in.fail();
+		m_travelSpeed = 0;
+	}
+}
 
 void Alien::setTravelSpeed(double amt)
 {
@@ -554,17 +575,17 @@ void Alien::setFlightPlanLen(int amt)
 
 void Alien::chooseRandDirection()
 {
-	m_dir = randInt(DOWN_LEFT, UP_LEFT);	// directions are random ints from DOWN_LEFT to UP_LEFT
-	m_flightPlanLen = randInt(1, 32);
+	m_dir = getWorld()->getAIRng().nextInt(DOWN_LEFT, UP_LEFT);	// directions are random ints from DOWN_LEFT to UP_LEFT
+	m_flightPlanLen = getWorld()->getAIRng().nextInt(1, 32);
 }
 
 void Alien::chooseOtherDirection(int notThisDir)
 {
 	if (notThisDir == DOWN_LEFT)
-		m_dir = randInt(LEFT, UP_LEFT);
+		m_dir = getWorld()->getAIRng().nextInt(LEFT, UP_LEFT);
 	else if (notThisDir == UP_LEFT)
-		m_dir = randInt(DOWN_LEFT, LEFT);
-	m_flightPlanLen = randInt(1, 32);
+		m_dir = getWorld()->getAIRng().nextInt(DOWN_LEFT, LEFT);
+	m_flightPlanLen = getWorld()->getAIRng().nextInt(1, 32);
 }
 
 /////////////////////////////////////////
@@ -585,17 +606,15 @@ Smoregon::Smoregon(double startY, StudentWorld* world)
 
 void Smoregon::possiblyDropItem()
 {
-	if (randInt(1, 3) == 1)	// 1/3 chance to drop
+	if (getWorld()->getAIRng().nextInt(1, 3) == 1)	// 1/3 chance to drop
 	{
-		if (randInt(1, 2) == 1)	// 1/2 chance to drop repair goodie
+		if (getWorld()->getAIRng().nextInt(1, 2) == 1)	// 1/2 chance to drop repair goodie
 		{
-			Repair* temp = new Repair(getX(), getY(), getWorld());
-			getWorld()->createActor(temp);
+			getWorld()->spawnActor<Repair>(getX(), getY(), getWorld());
 		}
 		else	// 1/2 chance to drop fTorpedo goodie
 		{
-			FTorpedoGoodie* temp = new FTorpedoGoodie(getX(), getY(), getWorld());
-			getWorld()->createActor(temp);
+			getWorld()->spawnActor<FTorpedoGoodie>(getX(), getY(), getWorld());
 		}
 	}
 }
@@ -652,18 +671,16 @@ void Snagglegon::moveAlien()
 
 void Snagglegon::shoot()
 {
-	FTorpedoProjectile* temp = new FTorpedoProjectile(getX() - 14, getY(), getWorld(), 180);
-	getWorld()->createActor(temp);
-	getWorld()->playSound(SOUND_TORPEDO);
+	getWorld()->spawnActor<FTorpedoProjectile>(getX() - 14, getY(), getWorld(), 180);
+	getWorld()->getEvents().sound(SOUND_TORPEDO);
 }
 
 void Snagglegon::possiblyDropItem()
 {
 	setScore(1000);		// snagglegons score 1000 points on death instead of 250
-	if (randInt(1, 6) == 1)	// 1/6 chance to drop
+	if (getWorld()->getAIRng().nextInt(1, 6) == 1)	// 1/6 chance to drop
 	{
-		ExtraLife* temp = new ExtraLife(getX(), getY(), getWorld());
-		getWorld()->createActor(temp);
+		getWorld()->spawnActor<ExtraLife>(getX(), getY(), getWorld());
 	}
 }
 
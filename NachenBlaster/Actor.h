@@ -2,7 +2,11 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "ActorHandle.h"
+#include "ActorKind.h"
 #include "StudentWorld.h"
+#include "WorldSnapshot.h"
+#include "PlayerAction.h"
 #include <cmath>
 
 
@@ -18,8 +22,8 @@ const int UP_LEFT   = 3;
 ///////////////////////////////////////////////////////////////
 
 class Actor;
-double euclidianDistance(double x1, double y1, double x2, double y2);	// returns the euclidian distance between two points
-double starSize();	// returns a random val (.05-.5) for star size
+class StudentWorld;
+ActorKind actorKind(int imageID, int dir);	// which kind an actor with this image and starting direction is
 bool   isAlien(const Actor* target);	// true if alien
 bool   isFriendlyProjectile(const Actor* target);	// true if friendly projectile
 bool   isEnemyProjectile(const Actor* target);	// true if enemy projectile
@@ -37,16 +41,27 @@ public:
 	// Actors take all parameters of a graph object + a pointer to the world they live in 
 	Actor(const int& imageID, const double& startX, const double& startY, 
 		  StudentWorld* world, Direction dir, double size, unsigned int depth = 0);
+	virtual ~Actor();
 	virtual void doSomething() = 0;	// we never create actor members
 	void collide(Actor& other);	// checks if this and other collide, and if so, does the proper action
+	void collideOverlapping(Actor& other);	// same, when we already know the two overlap (see findOverlaps)
+	virtual void moveTo(double x, double y);	// also keeps the world's copy of our position current
+	virtual void setSize(double size);	// ... and of our radius
+	virtual void warpTo(double x, double y);
+
+	// snapshots: everything that isn't fixed by the constructor, in a fixed order
+	virtual void saveState(SnapshotWriter& out) const;	// subclasses save the base first, then their own fields
+	virtual void loadState(SnapshotReader& in);	// ... and load in the same order
 	
 	// helper functions
 	void setHealth(int amt);	// health is only relevant for aliens/NB, but it's easier to just define for actors
 	int  getHealth() const;
 	virtual void takeDamage(int amt);
 	int  getActorID() const;	// returns the imageID (so we can tell what type of object each thing is)
+	ActorKind getKind() const;	// like getActorID, but tells friendly and enemy torpedoes apart
 	bool isAlive() const;	// true if alive, false if dead
 	int  getScore() const;	// returns how many points an actor should give (0 if it flies off the screen)
+	ActorHandle getHandle() const;	// safe way for others to refer to this actor (see StudentWorld::getActor)
 
 protected:
 	void setScore(int amt);		// useful for knowing when to increase score and when to play sounds
@@ -54,37 +69,12 @@ protected:
 	StudentWorld* getWorld() const;
 
 private:
-	virtual void collisionProperties(Actor& other) {}	// empty brackets so I don't redefine as empty for star/explosion
-	int  m_health;
+	virtual void collisionProperties(Actor& other) {}	// most actors don't do anything special when hit
+	ActorHotData& hot() const;	// position, radius, health and alive live in the world's table, at m_handle.index
 	int  m_actorID;
-	bool m_alive;
+	ActorKind m_kind;
 	int  m_scorePoints;
-	StudentWorld* m_world;
-};
-
-///////////////////////////////////////////////////////////////
-// STAR INTERFACE
-///////////////////////////////////////////////////////////////
-
-class Star : public Actor
-{
-public:
-	Star(double startY, StudentWorld* world);	// constructor for runtime
-	Star(double startX, double startY, StudentWorld* world);	// constructor for initialization
-	virtual void doSomething();	// move left each tick
-};
-
-///////////////////////////////////////////////////////////////
-// EXPLOSION INTERFACE
-///////////////////////////////////////////////////////////////
-
-class Explosion : public Actor
-{
-public:
-	Explosion(double startX, double startY, StudentWorld* world);
-	virtual void doSomething();	// increases in size or goes away each tick
-private:
-	int m_lifeTime;
+	ActorHandle m_handle;
 	StudentWorld* m_world;
 };
 
@@ -99,13 +89,15 @@ public:
 	virtual void doSomething();	// take user input and 
 	
 	// helper functions
-	void incTorpedoes(int amt);	// public so that goodies can increase our number of torpedoes
+	void incTorpedoes(int amt);	// public so that the world can hand over torpedoes from goodies
 	int getCabbageEnergy() const;	// public for the status line to use
 	int getNOfTorpedoes() const;	// public for the status line to use
+	virtual void saveState(SnapshotWriter& out) const;
+	virtual void loadState(SnapshotReader& in);
 
 private:
-	void moveShip(const int& dir);	// moves the ship in a direction 
-	void shootObject(const int& ch);	// shoots if passed SPACEBAR or TAB
+	void moveShip(const PlayerAction& action);	// moves the ship up to a step along each axis
+	void shootObject(const PlayerAction& action);	// fires a cabbage and/or a torpedo
 	virtual void takeDamage(int amt);	
 	virtual void collisionProperties(Actor& other);	// when colliding, calls the other actor's collision properties
 	int    m_cabbageEnergy;	
@@ -200,6 +192,8 @@ class Alien :public Actor
 public:
 	Alien(int imageID, double startY, StudentWorld* world);
 	virtual void doSomething();
+	virtual void saveState(SnapshotWriter& out) const;	// adds the flight plan
+	virtual void loadState(SnapshotReader& in);
 
 protected:
 	virtual void takeDamage(int amt);
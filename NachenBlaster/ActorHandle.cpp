@@ -0,0 +1,139 @@
+#include "ActorHandle.h"
+#include "WorldSnapshot.h"
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// more slots than this in a snapshot means it's corrupt
+const uint32_t MAX_SNAPSHOT_SLOTS = 1 << 16;
+
+ActorTable::ActorTable()
+	: m_placeNext(NO_PLACEMENT)
+{
+}
+
+ActorHandle ActorTable::add(Actor* actor, int kind)
+{
+	ActorHandle handle;
+	if (m_placeNext != NO_PLACEMENT)	// restoring a snapshot
+	{
+		handle.index = m_placeNext;
+		m_placeNext = NO_PLACEMENT;
+	}
+	else if (m_freeSlots.empty())	// no free slot, so make a new one
+	{
+		handle.index = m_generation.size();
+		m_generation.push_back(1);
+		m_hot.actor.push_back(nullptr);
+		m_hot.x.push_back(0);
+		m_hot.y.push_back(0);
+		m_hot.radius.push_back(0);
+		m_hot.health.push_back(0);
+		m_hot.alive.push_back(0);
+		m_hot.kind.push_back(0);
+	}
+	else	// reuse the most recently freed slot
+	{
+		handle.index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	handle.generation = m_generation[handle.index];
+	m_hot.actor[handle.index] = actor;
+	m_hot.alive[handle.index] = true;
+	m_hot.kind[handle.index] = static_cast<unsigned char>(kind);
+	return handle;
+}
+
+void ActorTable::remove(ActorHandle handle)
+{
+	if (get(handle) == nullptr)
+		return;
+	freeSlot(handle.index);
+	m_freeSlots.push_back(handle.index);
+}
+
+Actor* ActorTable::get(ActorHandle handle) const
+{
+	if (handle.index >= m_generation.size() || m_generation[handle.index] != handle.generation)
+		return nullptr;
+	return m_hot.actor[handle.index];
+}
+
+void ActorTable::clear()
+{
+	m_freeSlots.clear();
+	for (unsigned int i = m_generation.size(); i-- > 0; )	// so slot 0 is reused first
+	{
+		if (m_hot.actor[i] != nullptr)
+			freeSlot(i);
+		m_freeSlots.push_back(i);
+	}
+}
+
+void ActorTable::reserve(unsigned int nSlots)
+{
+	m_generation.reserve(nSlots);
+	m_freeSlots.reserve(nSlots);
+	m_hot.actor.reserve(nSlots);
+	m_hot.x.reserve(nSlots);
+	m_hot.y.reserve(nSlots);
+	m_hot.radius.reserve(nSlots);
+	m_hot.health.reserve(nSlots);
+	m_hot.alive.reserve(nSlots);
+	m_hot.kind.reserve(nSlots);
+}
+
+void ActorTable::save(SnapshotWriter& out) const
+{
+	out.writeArray(m_generation.data(), m_generation.size());
+	out.writeArray(m_freeSlots.data(), m_freeSlots.size());
+}
+
+void ActorTable::beginRestore(SnapshotReader& in)
+{
+	in.readArray(m_generation, MAX_SNAPSHOT_SLOTS);
+	in.readArray(m_freeSlots, MAX_SNAPSHOT_SLOTS);
+	unsigned int n = m_generation.size();
+	m_hot.actor.assign(n, nullptr);
+	m_hot.x.assign(n, 0);
+	m_hot.y.assign(n, 0);
+	m_hot.radius.assign(n, 0);
+	m_hot.health.assign(n, 0);
+	m_hot.alive.assign(n, 0);
+	m_hot.kind.assign(n, 0);
+	m_placeNext = NO_PLACEMENT;
+}
+
+bool ActorTable::placeNext(unsigned int index)
+{
+	if (index >= m_generation.size() || m_hot.actor[index] != nullptr)
+		return false;
+	m_placeNext = index;
+	return true;
+}
+
+bool ActorTable::endRestore() const
+{
+	unsigned int nEmpty = 0;
+	for (unsigned int i = 0; i < m_generation.size(); i++)
+		if (m_hot.actor[i] == nullptr)
+			nEmpty++;
+	if (nEmpty != m_freeSlots.size())
+		return false;
+	vector<unsigned char> listed(m_generation.size(), 0);
+	for (unsigned int i = 0; i < m_freeSlots.size(); i++)
+	{
+		unsigned int slot = m_freeSlots[i];
+		if (slot >= m_generation.size() || m_hot.actor[slot] != nullptr || listed[slot])
+			return false;
+		listed[slot] = 1;
+	}
+	return true;
+}
+
+void ActorTable::freeSlot(unsigned int index)
+{
+	m_hot.actor[index] = nullptr;
+	m_hot.alive[index] = false;
+	m_generation[index]++;	// old handles no longer match
+}
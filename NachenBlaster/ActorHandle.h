@@ -0,0 +1,92 @@
+#ifndef ACTORHANDLE_H_
+#define ACTORHANDLE_H_
+
+#include <vector>
+
+class Actor;
+class SnapshotWriter;
+class SnapshotReader;
+
+  // A reference to an actor that can outlive it. Each slot in the ActorTable
+  // counts how many times it has been reused, so a handle to an actor that has
+  // since been deleted (and whose slot now holds someone else) simply stops resolving.
+  // handle.index is also where the actor's hot data lives in ActorHotData.
+
+struct ActorHandle
+{
+	unsigned int index;
+	unsigned int generation;
+
+	bool operator==(const ActorHandle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const ActorHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+const ActorHandle NO_ACTOR = { ~0u, 0 };
+
+  // The fields every tick reads for every actor, kept as parallel arrays
+  // (one entry per table slot) so collision passes scan memory in order
+  // instead of chasing Actor pointers. Actors read and write their own entry.
+
+struct ActorHotData
+{
+	std::vector<Actor*>		   actor;	// nullptr if the slot is free
+	std::vector<double>		   x;
+	std::vector<double>		   y;
+	std::vector<double>		   radius;
+	std::vector<int>		   health;
+	std::vector<unsigned char> alive;
+	std::vector<unsigned char> kind;	// ActorKind
+};
+
+class ActorTable
+{
+public:
+	ActorTable();
+	ActorHandle add(Actor* actor, int kind);	// gives actor a slot and returns its handle
+	void remove(ActorHandle handle);	// frees the slot; handles to it stop resolving
+	Actor* get(ActorHandle handle) const;	// the actor, or nullptr if it's gone
+	void clear();	// frees every slot (the actors themselves aren't deleted)
+	void reserve(unsigned int nSlots);
+
+	  // Snapshots keep every slot's generation and the free list, so a restored world
+	  // hands out the same handles (and scans slots in the same order) as the original.
+	  // To restore: clear the world's actors, beginRestore, then placeNext(slot) before
+	  // constructing each actor, then endRestore.
+	void save(SnapshotWriter& out) const;
+	void beginRestore(SnapshotReader& in);
+	bool placeNext(unsigned int index);	// the next add() takes this slot; false if it isn't free
+	bool endRestore() const;	// true if exactly the slots that are free are on the free list
+
+	unsigned int size() const	// number of slots, free or not
+	{
+		return m_generation.size();
+	}
+
+	ActorHotData& hot()
+	{
+		return m_hot;
+	}
+
+	const ActorHotData& hot() const
+	{
+		return m_hot;
+	}
+
+private:
+	ActorHotData			  m_hot;
+	std::vector<unsigned int> m_generation;
+	std::vector<unsigned int> m_freeSlots;
+	unsigned int			  m_placeNext;	// slot for the next add(), or NO_PLACEMENT
+	static const unsigned int NO_PLACEMENT = ~0u;
+
+	void freeSlot(unsigned int index);
+};
+
+#endif // ACTORHANDLE_H_
@@ -0,0 +1,23 @@
+#ifndef ACTORKIND_H_
+#define ACTORKIND_H_
+
+// Concrete actor types, grouped by category so each category is a contiguous range.
+// Torpedoes get two kinds because who fired them decides what they can hit.
+// Stars and explosions aren't actors; see Starfield and ParticleSystem.
+enum ActorKind
+{
+	KIND_CABBAGE, KIND_FRIENDLY_TORPEDO,							// friendly projectiles
+	KIND_TURNIP, KIND_ENEMY_TORPEDO,								// enemy projectiles
+	KIND_REPAIR_GOODIE, KIND_LIFE_GOODIE, KIND_TORPEDO_GOODIE,		// goodies
+	KIND_SMALLGON, KIND_SMOREGON, KIND_SNAGGLEGON,					// aliens
+	KIND_NACHENBLASTER,
+	NUM_ACTOR_KINDS
+};
+
+const int FIRST_FRIENDLY_PROJECTILE_KIND = KIND_CABBAGE;
+const int FIRST_ENEMY_PROJECTILE_KIND	 = KIND_TURNIP;
+const int FIRST_GOODIE_KIND				 = KIND_REPAIR_GOODIE;
+const int FIRST_ALIEN_KIND				 = KIND_SMALLGON;
+const int LAST_ALIEN_KIND				 = KIND_SNAGGLEGON;
+
+#endif // ACTORKIND_H_
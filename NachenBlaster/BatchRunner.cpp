@@ -0,0 +1,80 @@
+#include "BatchRunner.h"
+#include "HeadlessDriver.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+using namespace std;
+
+BatchRunner::BatchRunner(string assetDir, unsigned int nWorkers)
+	: m_assetDir(assetDir), m_pool(nWorkers > 0 ? nWorkers : 1), m_maxTicks(~0UL),
+	  m_levels(nullptr), m_input(nullptr), m_rewindBudget(0), m_wallSeconds(0)
+{
+	m_keySource = [](uint64_t seed) { return HeadlessDriver::randomKeys(static_cast<unsigned int>(seed)); };
+	for (unsigned int i = 0; i < m_pool.getThreadCount(); i++)
+		m_drivers.push_back(make_unique<HeadlessDriver>(m_assetDir));
+}
+
+void BatchRunner::setMaxTicks(unsigned long maxTicks)
+{
+	m_maxTicks = maxTicks;
+}
+
+void BatchRunner::setKeySource(KeySourceFactory factory)
+{
+	m_keySource = factory;
+}
+
+void BatchRunner::setInput(InputSource* input)
+{
+	m_input = input;
+}
+
+void BatchRunner::setLevels(const LevelSchedule* levels)
+{
+	m_levels = levels;
+}
+
+void BatchRunner::setRewindBudget(size_t bytes)
+{
+	m_rewindBudget = bytes;
+}
+
+// one task per worker, each playing seeds until there are none left; every game writes only
+// its own entry of games, so the workers share nothing but the index of the next seed
+vector<BatchGame> BatchRunner::run(const vector<uint64_t>& seeds)
+{
+	vector<BatchGame> games(seeds.size());
+	atomic<size_t> next(0);
+	auto start = chrono::steady_clock::now();
+	m_pool.parallelFor(getWorkerCount(), 1, [&](unsigned int, unsigned int, unsigned int worker)
+	{
+		HeadlessDriver& driver = *m_drivers[worker];
+		driver.setThreadPool(nullptr);	// the batch is already using every thread
+		driver.setRewindBudget(m_rewindBudget);
+		driver.setLevels(m_levels);
+		driver.setInput(m_input);
+		for (size_t i = next.fetch_add(1); i < seeds.size(); i = next.fetch_add(1))
+		{
+			driver.setKeySource(m_keySource(seeds[i]));
+			games[i].seed = seeds[i];
+			games[i].worker = worker;
+			games[i].result = driver.runGame(m_maxTicks, seeds[i]);
+		}
+	});
+	m_wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return games;
+}
+
+unsigned int BatchRunner::getWorkerCount() const
+{
+	return static_cast<unsigned int>(m_drivers.size());
+}
+
+double BatchRunner::getWallSeconds() const
+{
+	return m_wallSeconds;
+}
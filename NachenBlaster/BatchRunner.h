@@ -0,0 +1,69 @@
+#ifndef BATCHRUNNER_H_
+#define BATCHRUNNER_H_
+
+#include "HeadlessDriver.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+class LevelSchedule;
+class InputSource;
+
+  // One game of a batch
+
+struct BatchGame
+{
+	std::uint64_t	seed;
+	unsigned int	worker;		// which worker played it
+	HeadlessResult	result;
+};
+
+  // Plays a list of seeds headless, each to game over (or a tick limit), on a
+  // ThreadPool with one worker per thread. Each worker has its own HeadlessDriver
+  // and keeps reusing its one world (see StudentWorld::reset), so after the first
+  // few games a worker allocates next to nothing. Workers take the next seed as
+  // they finish, so long and short games even out. A game's keys depend only on
+  // its seed, so a seed plays the same game whichever worker gets it.
+  //
+  //     BatchRunner batch("Assets", 8);
+  //     std::vector<BatchGame> games = batch.run(seeds);
+
+class BatchRunner
+{
+public:
+	using KeySourceFactory = std::function<HeadlessDriver::KeySource(std::uint64_t seed)>;
+
+	BatchRunner(std::string assetDir, unsigned int nWorkers);
+
+	void setMaxTicks(unsigned long maxTicks);	// per game (default: play to the end)
+	void setKeySource(KeySourceFactory factory);	// keys for the game with each seed (default: randomKeys(seed))
+	void setInput(InputSource* input);	// plays every game instead of the keys; shared by all workers, so it mustn't keep state
+	void setLevels(const LevelSchedule* levels);	// nullptr: random levels
+	void setRewindBudget(std::size_t bytes);	// per world (default 0: nothing rewinds in a batch)
+
+	std::vector<BatchGame> run(const std::vector<std::uint64_t>& seeds);	// in the order of seeds
+
+	unsigned int getWorkerCount() const;
+	double getWallSeconds() const;	// how long the last run took from start to finish
+
+private:
+	std::string		m_assetDir;
+	ThreadPool		m_pool;
+	std::vector<std::unique_ptr<HeadlessDriver>> m_drivers;	// one per worker, kept between runs
+	unsigned long	m_maxTicks;
+	KeySourceFactory m_keySource;
+	const LevelSchedule* m_levels;
+	InputSource*	m_input;
+	std::size_t		m_rewindBudget;
+	double			m_wallSeconds;
+
+	// Prevent copying or assigning BatchRunners
+	BatchRunner(const BatchRunner&) = delete;
+	BatchRunner& operator=(const BatchRunner&) = delete;
+};
+
+#endif // BATCHRUNNER_H_
@@ -0,0 +1,162 @@
+#include "CollisionKernel.h"
+using namespace std;
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NB_X86_KERNELS
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles any intrinsic without being asked; gcc and clang need the function marked
+#if defined(NB_X86_KERNELS) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+// scalar test of candidates [first, n), for the whole block or whatever's left after the SIMD loop
+static unsigned int findOverlapsFrom(unsigned int first, double x, double y, double radius,
+									 const double* xs, const double* ys, const double* radii,
+									 unsigned int n, unsigned int* hits)
+{
+	unsigned int nHits = 0;
+	for (unsigned int i = first; i < n; i++)
+		if (overlaps(x, y, radius, xs[i], ys[i], radii[i]))
+			hits[nHits++] = i;
+	return nHits;
+}
+
+static unsigned int findOverlapsScalar(double x, double y, double radius,
+									   const double* xs, const double* ys, const double* radii,
+									   unsigned int n, unsigned int* hits)
+{
+	return findOverlapsFrom(0, x, y, radius, xs, ys, radii, n, hits);
+}
+
+#ifdef NB_X86_KERNELS
+
+// reach is .75 * (r1 + r2), computed in the same order as collisionReach so the answers match bit for bit
+
+static unsigned int findOverlapsSSE2(double x, double y, double radius,
+									 const double* xs, const double* ys, const double* radii,
+									 unsigned int n, unsigned int* hits)
+{
+	const __m128d px = _mm_set1_pd(x), py = _mm_set1_pd(y), pr = _mm_set1_pd(radius);
+	const __m128d factor = _mm_set1_pd(.75);
+	unsigned int nHits = 0, i = 0;
+	for (; i + 2 <= n; i += 2)
+	{
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), px);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), py);
+		__m128d reach = _mm_mul_pd(factor, _mm_add_pd(pr, _mm_loadu_pd(radii + i)));
+		__m128d dist2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+		int mask = _mm_movemask_pd(_mm_cmplt_pd(dist2, _mm_mul_pd(reach, reach)));
+		// write every lane, but only advance past the hits; cheaper than branching on mostly-misses
+		hits[nHits] = i;
+		nHits += mask & 1;
+		hits[nHits] = i + 1;
+		nHits += (mask >> 1) & 1;
+	}
+	return nHits + findOverlapsFrom(i, x, y, radius, xs, ys, radii, n, hits + nHits);
+}
+
+TARGET_AVX2
+static unsigned int findOverlapsAVX2(double x, double y, double radius,
+									 const double* xs, const double* ys, const double* radii,
+									 unsigned int n, unsigned int* hits)
+{
+	const __m256d px = _mm256_set1_pd(x), py = _mm256_set1_pd(y), pr = _mm256_set1_pd(radius);
+	const __m256d factor = _mm256_set1_pd(.75);
+	unsigned int nHits = 0, i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		// no fused multiply-add: it rounds differently, and the scalar code doesn't use it
+		__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), px);
+		__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), py);
+		__m256d reach = _mm256_mul_pd(factor, _mm256_add_pd(pr, _mm256_loadu_pd(radii + i)));
+		__m256d dist2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		int mask = _mm256_movemask_pd(_mm256_cmp_pd(dist2, _mm256_mul_pd(reach, reach), _CMP_LT_OQ));
+		for (unsigned int lane = 0; lane < 4; lane++)
+		{
+			hits[nHits] = i + lane;
+			nHits += (mask >> lane) & 1;
+		}
+	}
+	return nHits + findOverlapsFrom(i, x, y, radius, xs, ys, radii, n, hits + nHits);
+}
+
+static bool cpuHasAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;	// OSXSAVE, and XMM + YMM state enabled
+	if (!osSavesYmm)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // NB_X86_KERNELS
+
+bool collisionKernelSupported(CollisionKernelKind kind)
+{
+	return getOverlapFunc(kind) != nullptr;
+}
+
+const char* collisionKernelName(CollisionKernelKind kind)
+{
+	switch (kind)
+	{
+	case KERNEL_SCALAR:	return "scalar";
+	case KERNEL_SSE2:	return "sse2";
+	case KERNEL_AVX2:	return "avx2";
+	default:			return "?";
+	}
+}
+
+OverlapFunc getOverlapFunc(CollisionKernelKind kind)
+{
+	switch (kind)
+	{
+	case KERNEL_SCALAR:	return findOverlapsScalar;
+#ifdef NB_X86_KERNELS
+	case KERNEL_SSE2:	return findOverlapsSSE2;	// every x86-64 CPU, and every x86 one built for /arch:SSE2 (the default)
+	case KERNEL_AVX2:
+	{
+		static const bool hasAVX2 = cpuHasAVX2();
+		return hasAVX2 ? findOverlapsAVX2 : nullptr;
+	}
+#endif
+	default:			return nullptr;
+	}
+}
+
+CollisionKernelKind bestCollisionKernel()
+{
+	static const CollisionKernelKind best = []()
+	{
+		for (int kind = NUM_COLLISION_KERNELS - 1; kind > KERNEL_SCALAR; kind--)
+			if (collisionKernelSupported(static_cast<CollisionKernelKind>(kind)))
+				return static_cast<CollisionKernelKind>(kind);
+		return KERNEL_SCALAR;
+	}();
+	return best;
+}
+
+unsigned int findOverlaps(double x, double y, double radius,
+						  const double* xs, const double* ys, const double* radii,
+						  unsigned int n, unsigned int* hits)
+{
+	static const OverlapFunc best = getOverlapFunc(bestCollisionKernel());
+	return best(x, y, radius, xs, ys, radii, n, hits);
+}
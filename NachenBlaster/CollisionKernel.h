@@ -0,0 +1,45 @@
+#ifndef COLLISIONKERNEL_H_
+#define COLLISIONKERNEL_H_
+
+#include "SpatialGrid.h"
+
+  // Narrowphase: which of a block of candidates overlap one actor. Two things
+  // overlap when they're closer than collisionReach of their radii; everything
+  // here compares squared distances, so no pair costs a sqrt.
+  //
+  // findOverlaps writes the positions (0 .. n-1) of the overlapping candidates
+  // to hits, in increasing order, and returns how many there were. hits must
+  // have room for n entries. The SIMD versions give exactly the scalar answers.
+
+enum CollisionKernelKind
+{
+	KERNEL_SCALAR,
+	KERNEL_SSE2,
+	KERNEL_AVX2,
+	NUM_COLLISION_KERNELS
+};
+
+using OverlapFunc = unsigned int (*)(double x, double y, double radius,
+									 const double* xs, const double* ys, const double* radii,
+									 unsigned int n, unsigned int* hits);
+
+  // True if this build has the kernel and this CPU can run it
+bool collisionKernelSupported(CollisionKernelKind kind);
+const char* collisionKernelName(CollisionKernelKind kind);
+OverlapFunc getOverlapFunc(CollisionKernelKind kind);	// nullptr if unsupported
+CollisionKernelKind bestCollisionKernel();	// picked once, the first time it's asked for
+
+  // Uses the best kernel this CPU supports
+unsigned int findOverlaps(double x, double y, double radius,
+						  const double* xs, const double* ys, const double* radii,
+						  unsigned int n, unsigned int* hits);
+
+  // One pair at a time, for when there's no block to batch up
+inline bool overlaps(double x1, double y1, double radius1, double x2, double y2, double radius2)
+{
+	double dx = x2 - x1, dy = y2 - y1;
+	double reach = collisionReach(radius1, radius2);
+	return dx * dx + dy * dy < reach * reach;
+}
+
+#endif // COLLISIONKERNEL_H_
@@ -0,0 +1,78 @@
+#ifndef EVENTQUEUE_H_
+#define EVENTQUEUE_H_
+
+#include <vector>
+#include <cstdint>
+
+  // Side effects of a tick that reach outside the actor doing them: sounds, score,
+  // extra lives and torpedoes for the user. Actors push them here as they happen
+  // instead of touching the world, the user or the GameController, and the world
+  // applies them all in one pass at the end of move() (see StudentWorld::applyEvents).
+  // Nothing reads lives, score or torpedoes in the middle of a tick, so the game
+  // comes out the same either way.
+
+enum WorldEventType : std::uint8_t
+{
+	EVENT_SOUND,		// value: SOUND_*; the same sound twice in a tick plays once
+	EVENT_SCORE,		// value: points
+	EVENT_EXTRA_LIFE,
+	EVENT_TORPEDOES,	// value: torpedoes for the user
+};
+
+struct WorldEvent
+{
+	WorldEventType	type;
+	int				value;
+};
+
+class EventQueue
+{
+public:
+	static const unsigned int INITIAL_CAPACITY = 256;	// plenty for an ordinary tick
+
+	EventQueue()
+	{
+		m_events.reserve(INITIAL_CAPACITY);
+	}
+
+	void sound(int soundID)
+	{
+		push(EVENT_SOUND, soundID);
+	}
+
+	void score(int points)
+	{
+		push(EVENT_SCORE, points);
+	}
+
+	void extraLife()
+	{
+		push(EVENT_EXTRA_LIFE, 1);
+	}
+
+	void torpedoes(int amt)
+	{
+		push(EVENT_TORPEDOES, amt);
+	}
+
+	const std::vector<WorldEvent>& events() const	// in the order they were pushed
+	{
+		return m_events;
+	}
+
+	void clear()	// keeps the capacity for the next tick
+	{
+		m_events.clear();
+	}
+
+private:
+	std::vector<WorldEvent> m_events;
+
+	void push(WorldEventType type, int value)
+	{
+		WorldEvent e = { type, value };
+		m_events.push_back(e);
+	}
+};
+
+#endif // EVENTQUEUE_H_
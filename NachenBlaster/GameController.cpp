@@ -5,6 +5,7 @@
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
+#include "TickProfiler.h"
 #include <string>
 #include <map>
 #include <utility>
@@ -43,8 +44,16 @@ static const double SCORE_Z = -10;
 
 static const int MS_PER_FRAME = 5;
 
+  // the old lockstep loop spent one timer callback per tick moving and
+  // ANIMATION_POSITIONS_PER_TICK + 1 drawing, so this keeps gameplay at the same speed
+static const double DEFAULT_TICKS_PER_SECOND = 1000.0 / (MS_PER_FRAME * (ANIMATION_POSITIONS_PER_TICK + 2));
+static const double MAX_CATCH_UP_SECONDS = .25;	// after a stall, drop time rather than run a burst of ticks
+
+static const char* const QUICKSAVE_FILE = "quicksave.nbs";	// F5 saves the game here, F9 loads it
+static const double REWIND_SECONDS = 2;	// how far back F7 goes
+
 static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void drawScoreAndLives(const string&, Rng& rng);
 
 enum GameController::GameControllerState : int {
 	welcome, init, makemove, animate, contgame, finishedlevel, cleanup, gameover, prompt, quit, not_applicable
@@ -98,40 +107,67 @@ void GameController::initDrawersAndSounds()
 		m_soundMap[sounds[k].first] = sounds[k].second;
 }
 
+static GameController* s_running = nullptr;	// the controller GLUT's callbacks go to (see run)
+
 static void doSomethingCallback()
 {
-	Game().doSomething();
+	s_running->doSomething();
 }
 
 static void reshapeCallback(int w, int h)
 {
-	Game().reshape(w, h);
+	s_running->reshape(w, h);
 }
 
 static void keyboardEventCallback(unsigned char key, int x, int y)
 {
-	Game().keyboardEvent(key, x, y);
+	s_running->keyboardEvent(key, x, y);
 }
 
 static void specialKeyboardEventCallback(int key, int x, int y)
 {
-	Game().specialKeyboardEvent(key, x, y);
+	s_running->specialKeyboardEvent(key, x, y);
 }
 
 static void timerFuncCallback(int)
 {
-	Game().doSomething();
-	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
+	s_running->doSomething();
+	glutTimerFunc(s_running->getMsPerFrame(), timerFuncCallback, 0);
+}
+
+GameController::GameController()
+	: m_gw(nullptr), m_gameState(not_applicable), m_nextStateAfterPrompt(not_applicable), m_nextStateAfterAnimate(not_applicable),
+	  m_lastKeyHit(INVALID_KEY), m_singleStep(false), m_autoContinue(false),
+	  m_ticksPerSecond(DEFAULT_TICKS_PER_SECOND), m_msPerFrame(MS_PER_FRAME), m_unsimulatedTime(0), m_playerWon(false)
+{
+}
+
+void GameController::setTickRate(double ticksPerSecond)
+{
+	if (ticksPerSecond > 0)
+		m_ticksPerSecond = ticksPerSecond;
+}
+
+void GameController::setFrameRate(double framesPerSecond)
+{
+	if (framesPerSecond > 0)
+		m_msPerFrame = max(1, static_cast<int>(1000 / framesPerSecond));
+}
+
+void GameController::setAutoContinue(bool on)
+{
+	m_autoContinue = on;
 }
 
 void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
 {
 	gw->setController(this);
+	gw->setProfiler(&m_profiler);
 	m_gw = gw;
+	s_running = this;
 	setGameState(welcome);
 	m_lastKeyHit = INVALID_KEY;
 	m_singleStep = false;
-	m_curIntraFrameTick = 0;
 	m_playerWon = false;
 
 	glutInit(&argc, argv);
@@ -147,11 +183,13 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 	glutSpecialFunc(specialKeyboardEventCallback);
 	glutReshapeFunc(reshapeCallback);
 	glutDisplayFunc(doSomethingCallback);
-	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
+	glutTimerFunc(m_msPerFrame, timerFuncCallback, 0);
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 	glutMainLoop();
 	delete m_gw;
+	m_gw = nullptr;
+	s_running = nullptr;
 }
 
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
@@ -165,6 +203,7 @@ void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
 	case 't':			m_lastKeyHit = KEY_PRESS_TAB;	break;
 	case 'f':			m_singleStep = true;			break;
 	case 'r':			m_singleStep = false;			break;
+	case 'p':			m_profiler.report(cout);		break;
 	case 'q': case 'Q': setGameState(quit);				break;
 	default:			m_lastKeyHit = key;				break;
 	}
@@ -178,6 +217,9 @@ void GameController::specialKeyboardEvent(int key, int /* x */, int /* y */)
 	case GLUT_KEY_RIGHT: m_lastKeyHit = KEY_PRESS_RIGHT; break;
 	case GLUT_KEY_UP:	 m_lastKeyHit = KEY_PRESS_UP;	 break;
 	case GLUT_KEY_DOWN:	 m_lastKeyHit = KEY_PRESS_DOWN;	 break;
+	case GLUT_KEY_F5:	 quickSaveOrLoad(true);			 break;
+	case GLUT_KEY_F7:	 rewind();						 break;
+	case GLUT_KEY_F9:	 quickSaveOrLoad(false);		 break;
 	default:			 m_lastKeyHit = INVALID_KEY;	 break;
 	}
 }
@@ -186,7 +228,7 @@ void GameController::playSound(int soundID)
 {
 	if (soundID == SOUND_NONE)
 	{
-		SoundFX().abortClip();
+		m_sound.abortClip();
 		return;
 	}
 
@@ -196,7 +238,7 @@ void GameController::playSound(int soundID)
 		string path = m_gw->assetDirectory();
 		if (!path.empty())
 			path += '/';
-		SoundFX().playClip(path + p->second);
+		m_sound.playClip(path + p->second);
 	}
 }
 
@@ -234,7 +276,7 @@ void GameController::doSomething()
 	case init:
 	{
 		int status = m_gw->init();
-		SoundFX().abortClip();
+		m_sound.abortClip();
 		if (status == GWSTATUS_PLAYER_WON)
 		{
 			m_playerWon = true;
@@ -245,41 +287,20 @@ void GameController::doSomething()
 				"Error in level data file encoding!",
 				"Press Enter to quit...");
 		else
+		{
+			m_unsimulatedTime = 0;
+			m_lastFrameTime = chrono::steady_clock::now();
 			setGameState(makemove);
+		}
 	}
 	break;
 	case makemove:
-		m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-		m_nextStateAfterAnimate = not_applicable;
-		{
-			int status = m_gw->move();
-			if (status == GWSTATUS_PLAYER_DIED)
-			{
-				// animate one last frame so the player can see what happened
-				m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
-			}
-			else if (status == GWSTATUS_FINISHED_LEVEL)
-			{
-				m_gw->advanceToNextLevel();
-				// animate one last frame so the player can see what happened
-				m_nextStateAfterAnimate = finishedlevel;
-			}
-		}
-		setGameState(animate);
+		simulateAndDisplay();
 		break;
 	case animate:
-		displayGamePlay();
-		if (m_curIntraFrameTick-- <= 0)
-		{
-			if (m_nextStateAfterAnimate != not_applicable)
-				setGameState(m_nextStateAfterAnimate);
-			else
-			{
-				int key;
-				if (!m_singleStep || getLastKey(key))
-					setGameState(makemove);
-			}
-		}
+		// animate one last frame so the player can see what happened
+		displayGamePlay(1);
+		setGameState(m_nextStateAfterAnimate);
 		break;
 	case contgame:
 		setGameStateAfterPrompting(cleanup, "You lost a life!",
@@ -306,19 +327,82 @@ void GameController::doSomething()
 		drawPrompt(m_mainMessage, m_secondMessage);
 		{
 			int key;
-			if (getLastKey(key) && key == '\r')
+			if (m_autoContinue || (getLastKey(key) && key == '\r'))
 				setGameState(m_nextStateAfterPrompt);
 		}
 		break;
 	case quit:
-		SoundFX().abortClip();
+#ifdef NB_PROFILE
+		m_profiler.report(cout);
+#endif
+		m_sound.abortClip();
 		glutLeaveMainLoop();
 		break;
 	}
 }
 
-void GameController::displayGamePlay()
+void GameController::quickSaveOrLoad(bool save)
+{
+	if (m_gw == nullptr || m_gameState != makemove)	// only in the middle of a level
+		return;
+	bool ok = (save ? m_gw->quickSave(QUICKSAVE_FILE) : m_gw->quickLoad(QUICKSAVE_FILE));
+	cout << (save ? "saving to " : "loading from ") << QUICKSAVE_FILE << (ok ? "" : " failed") << endl;
+}
+
+void GameController::rewind()
+{
+	if (m_gw == nullptr || m_gameState != makemove)
+		return;
+	if (!m_gw->rewind(static_cast<unsigned int>(REWIND_SECONDS * m_ticksPerSecond)))
+		cout << "can't rewind" << endl;
+}
+
+void GameController::simulateAndDisplay()
+{
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	double elapsed = chrono::duration<double>(now - m_lastFrameTime).count();
+	m_lastFrameTime = now;
+
+	double secondsPerTick = 1 / m_ticksPerSecond;
+	if (m_singleStep)
+	{
+		int key;
+		m_unsimulatedTime = (getLastKey(key) ? secondsPerTick : 0);	// one tick per key press
+	}
+	else
+		m_unsimulatedTime += min(elapsed, MAX_CATCH_UP_SECONDS);
+
+	while (m_unsimulatedTime >= secondsPerTick)
+	{
+		m_unsimulatedTime -= secondsPerTick;
+		if (!runTick())
+			return;		// the animate state shows the final frame
+		if (m_gameState != makemove)	// the world asked to quit
+			return;
+	}
+	displayGamePlay(m_singleStep ? 1 : m_unsimulatedTime / secondsPerTick);
+}
+
+bool GameController::runTick()
+{
+	m_gw->getGraphObjects().startTick();
+	int status = m_gw->move();
+	if (status == GWSTATUS_PLAYER_DIED)
+		m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
+	else if (status == GWSTATUS_FINISHED_LEVEL)
+	{
+		m_gw->advanceToNextLevel();
+		m_nextStateAfterAnimate = finishedlevel;
+	}
+	else
+		return true;
+	setGameState(animate);
+	return false;
+}
+
+void GameController::displayGamePlay(double alpha)
 {
+	PROFILE_PHASE(&m_profiler, PHASE_DISPLAY);
 	glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
 	glLoadIdentity();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -331,15 +415,29 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
-	GraphObject::drawAllObjects(
-		[=](int imageID, int animationNumber, double x, double y, int angle, double size)
-	{
-		int frame = animationNumber % m_spriteManager.getNumFrames(imageID);
-		m_spriteManager.plotSprite(imageID, frame, x, y, angle, size);
+	// the background goes down first, a batch at a time, so everything else is drawn over it
+	m_background.clear();
+	if (m_gw != nullptr)
+		m_gw->getBackground(m_background);
+	for (const SpriteBatch& batch : m_background)
+		m_spriteManager.plotSpriteBatch(batch, 0, alpha);
+
+	if (m_gw != nullptr)
+		m_gw->getGraphObjects().drawAllObjects(
+			[=](int imageID, int animationNumber, double x, double y, int angle, double size)
+		{
+			int frame = animationNumber % m_spriteManager.getNumFrames(imageID);
+			m_spriteManager.plotSprite(imageID, frame, x, y, angle, size);
+
+		}, alpha);
 
-	});
+	m_foreground.clear();
+	if (m_gw != nullptr)
+		m_gw->getForeground(m_foreground);
+	for (const SpriteBatch& batch : m_foreground)
+		m_spriteManager.plotSpriteBatch(batch, 0, alpha);
 
-	drawScoreAndLives(m_gameStatText);
+	drawScoreAndLives(m_gameStatText, m_hudRng);
 
 	glutSwapBuffers();
 }
@@ -399,14 +497,14 @@ static void drawPrompt(string mainMessage, string secondMessage)
 	glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+static void drawScoreAndLives(const string& gameStatText, Rng& rng)
 {
 	static int RATE = 1;
 	static GLfloat rgb[3] =
 	{ static_cast<GLfloat>(.6), static_cast<GLfloat>(.6), static_cast<GLfloat>(.6) };
 	for (int k = 0; k < 3; k++)
 	{
-		double strength = rgb[k] + randInt(-RATE, RATE) / 100.0;
+		double strength = rgb[k] + rng.nextInt(-RATE, RATE) / 100.0;
 		if (strength < .6)
 			strength = .6;
 		else if (strength > 1.0)
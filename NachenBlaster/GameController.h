@@ -2,22 +2,45 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "GameWorld.h"
+#include "Random.h"
+#include "SoundFX.h"
+#include "TickProfiler.h"
 #include <string>
+#include <string_view>
 #include <map>
 #include <iostream>
 #include <sstream>
+#include <chrono>
+#include <vector>
 
 const int INVALID_KEY = 0;
 
 class GraphObject;
-class GameWorld;
 
-class GameController
+  // Runs one world in a GLUT window, with sound. GLUT has one window loop per
+  // process, so only one GameController can be in run() at a time; worlds
+  // without a window (HeadlessDriver) have no such limit.
+
+class GameController : public GameHost
 {
   public:
+	GameController();
+
 	void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle);
 
-	bool getLastKey(int& value)
+	  // The simulation advances at a fixed tick rate no matter how often the
+	  // screen is redrawn; frames in between ticks are interpolated.
+	void setTickRate(double ticksPerSecond);
+	void setFrameRate(double framesPerSecond);
+	void setAutoContinue(bool on);	// skip the "Press Enter" prompts, e.g. when watching a replay
+
+	int getMsPerFrame() const
+	{
+		return m_msPerFrame;
+	}
+
+	virtual bool getLastKey(int& value)
 	{
 		if (m_lastKeyHit != INVALID_KEY)
 		{
@@ -28,11 +51,11 @@ class GameController
 		return false;
 	}
 
-	void playSound(int soundID);
+	virtual void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	virtual void setGameStatText(std::string_view text)
 	{
-		m_gameStatText = text;
+		m_gameStatText.assign(text);	// reuses the string's buffer
 	}
 
 	void doSomething();
@@ -41,14 +64,7 @@ class GameController
 	void keyboardEvent(unsigned char key, int x, int y);
 	void specialKeyboardEvent(int key, int x, int y);
 
-	void quitGame();
-
-	  // Meyers singleton pattern
-	static GameController& getInstance()
-	{
-		static GameController instance;
-		return instance;
-	}
+	virtual void quitGame();
 
 private:
 	enum GameControllerState : int;
@@ -59,27 +75,35 @@ private:
 	GameControllerState	m_nextStateAfterAnimate;
 	int			m_lastKeyHit;
 	bool		m_singleStep;
+	bool		m_autoContinue;
 	std::string m_gameStatText;
 	std::string m_mainMessage;
 	std::string m_secondMessage;
-	int			m_curIntraFrameTick;
+	double		m_ticksPerSecond;
+	int			m_msPerFrame;
+	double		m_unsimulatedTime;	// seconds of real time not yet covered by a tick
+	std::chrono::steady_clock::time_point m_lastFrameTime;
 	using SoundMapType = std::map<int, std::string>;
 	using DrawMapType =  std::map<int, std::string>;
 	SoundMapType  m_soundMap;
 	bool		  m_playerWon;
 	SpriteManager m_spriteManager;
+	Rng			  m_hudRng;	// makes the status line shimmer
+	std::vector<SpriteBatch> m_background;	// refilled from the world each frame
+	std::vector<SpriteBatch> m_foreground;
+	SoundFXController m_sound;
+	TickProfiler  m_profiler;	// the world's and our own timings ('p' prints them)
 
 	void setGameState(GameControllerState s);
 	void setGameStateAfterPrompting(GameControllerState s,
 							std::string mainMessage, std::string secondMessage);
 
 	void initDrawersAndSounds();
-	void displayGamePlay();
+	void simulateAndDisplay();	// runs the ticks that are due, then draws
+	bool runTick();	// false if the tick ended the life or the level
+	void displayGamePlay(double alpha);
+	void quickSaveOrLoad(bool save);
+	void rewind();
 };
 
-inline GameController& Game()
-{
-	return GameController::getInstance();
-}
-
 #endif // GAMECONTROLLER_H_
@@ -2,11 +2,31 @@
 #define GAMEWORLD_H_
 
 #include "GameConstants.h"
+#include "SpriteBatch.h"
+#include "GraphObject.h"
 #include <string>
+#include <string_view>
+#include <vector>
 
 const int START_PLAYER_LIVES = 3;
 
-class GameController;
+  // Whatever drives a GameWorld (the GLUT GameController or the HeadlessDriver)
+  // hands it keys and takes its sounds and status text through this interface.
+
+class TickProfiler;
+
+class GameHost
+{
+public:
+	virtual ~GameHost()
+	{
+	}
+
+	virtual bool getLastKey(int& value) = 0;
+	virtual void playSound(int soundID) = 0;
+	virtual void setGameStatText(std::string_view text) = 0;	// copy it: it's only valid during the call
+	virtual void quitGame() = 0;
+};
 
 class GameWorld
 {
@@ -14,7 +34,7 @@ public:
 
 	GameWorld(std::string assetDir)
 	 : m_lives(START_PLAYER_LIVES), m_score(0), m_level(1),
-	   m_controller(nullptr), m_assetDir(assetDir)
+	   m_controller(nullptr), m_profiler(nullptr), m_assetDir(assetDir)
 	{
 	}
 
@@ -26,7 +46,33 @@ public:
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
-	void setGameStatText(std::string text);
+	  // Scenery and effects that aren't made of GraphObjects, drawn behind and in front of all of them
+	virtual void getBackground(std::vector<SpriteBatch>& batches) const
+	{
+	}
+
+	virtual void getForeground(std::vector<SpriteBatch>& batches) const
+	{
+	}
+
+	  // Save the game in progress to a file and pick it up again; false if that failed or isn't supported
+	virtual bool quickSave(const std::string& path) const
+	{
+		return false;
+	}
+
+	virtual bool quickLoad(const std::string& path)
+	{
+		return false;
+	}
+
+	  // Go back up to ticks ticks; false if there's nothing to go back to or it isn't supported
+	virtual bool rewind(unsigned int ticks)
+	{
+		return false;
+	}
+
+	void setGameStatText(std::string_view text);
 
 	bool getKey(int& value);
 	void playSound(int soundID);
@@ -72,23 +118,56 @@ public:
 	{
 		++m_level;
 	}
+
+	void restoreProgress(unsigned int lives, unsigned int score, unsigned int level)	// for loading snapshots
+	{
+		m_lives = lives;
+		m_score = score;
+		m_level = level;
+	}
    
-	void setController(GameController* controller)
+	void setController(GameHost* controller)
 	{
 		m_controller = controller;
 	}
 
+	GameHost* getController() const
+	{
+		return m_controller;
+	}
+
 	std::string assetDirectory() const
 	{
 		return m_assetDir;
 	}
-	
+
+	  // Everything the world shows on screen. Each world has its own, so several can
+	  // run side by side, each on its own thread.
+	GraphObjectRegistry& getGraphObjects()
+	{
+		return m_graphObjects;
+	}
+
+	  // Where the world's PROFILE_PHASE timings go (nullptr: nowhere). Whatever drives
+	  // the world owns it, and only that thread may record into it.
+	void setProfiler(TickProfiler* profiler)
+	{
+		m_profiler = profiler;
+	}
+
+	TickProfiler* getProfiler() const
+	{
+		return m_profiler;
+	}
+
 private:
 	unsigned int	m_lives;
 	unsigned int	m_score;
 	unsigned int	m_level;
-	GameController* m_controller;
+	GameHost*		m_controller;
+	TickProfiler*	m_profiler;
 	std::string		m_assetDir;
+	GraphObjectRegistry m_graphObjects;
 };
 
 #endif // GAMEWORLD_H_
@@ -2,38 +2,31 @@
 #define GRAPHOBJ_H_
 
 #include "GameConstants.h"
-#include <set>
 
 const int ANIMATION_POSITIONS_PER_TICK = 1;
 
 using Direction = int;
 
+class GraphObjectRegistry;
+
 class GraphObject
 {
 protected:
-	GraphObject(int imageID, double startX, double startY, int dir = 0, double size = 1.0, int depth = 0)
-		: m_imageID(imageID), m_animationNumber(0), m_x(startX), m_y(startY),
-		m_destX(startX), m_destY(startY), m_direction(dir),
-		m_size(size <= 0 ? 1 : size), m_depth(depth)
-	{
-		getGraphObjects(m_depth).insert(this);
-	}
+	  // Each object lives in one world's registry (see GameWorld::getGraphObjects)
+	GraphObject(GraphObjectRegistry& registry, int imageID, double startX, double startY, int dir = 0, double size = 1.0, int depth = 0);
 
 public:
-	virtual ~GraphObject()
-	{
-		getGraphObjects(m_depth).erase(this);
-	}
+	virtual ~GraphObject();
 
 	double getX() const
 	{
-		// If already moved but not yet animated, use new location anyway.
+		// Where the object is as of the latest tick (not where it's being drawn).
 		return m_destX;
 	}
 
 	double getY() const
 	{
-		// If already moved but not yet animated, use new location anyway.
+		// Where the object is as of the latest tick (not where it's being drawn).
 		return m_destY;
 	}
 
@@ -44,6 +37,13 @@ public:
 		m_animationNumber++;
 	}
 
+	  // Puts the object at (x, y) without drawing it sliding there
+	virtual void warpTo(double x, double y)
+	{
+		m_x = m_destX = x;
+		m_y = m_destY = y;
+	}
+
 	int getDirection() const
 	{
 		return m_direction;
@@ -57,7 +57,7 @@ public:
 		m_direction = d % 360;
 	}
 
-	void setSize(double size)
+	virtual void setSize(double size)
 	{
 		m_size = size;
 	}
@@ -73,62 +73,126 @@ public:
 		return RADIUS_PER_UNIT * m_size;
 	}
 
-	template<typename Func>
-	static void drawAllObjects(Func plotFunc)
-	{
-		for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--)
-		{
-			for (GraphObject* go : getGraphObjects(depth))
-			{
-				go->animate();
-				plotFunc(go->m_imageID, go->m_animationNumber, go->m_x, go->m_y, go->m_direction, go->m_size);
-			}
-		}
-	}
-
 private:
-	static const int NUM_DEPTHS = 4;
+	friend class GraphObjectRegistry;
+
+	GraphObjectRegistry* m_registry;
 	int             m_imageID;
 	unsigned int    m_animationNumber;
-	double          m_x;
+	double          m_x;		// position at the start of the current tick
 	double          m_y;
-	double          m_destX;
+	double          m_destX;	// position at the end of it
 	double          m_destY;
 	int				m_direction;
 	double          m_size;
 	int             m_depth;
+	GraphObject*	m_prevObject;	// neighbours in the list of objects at this depth
+	GraphObject*	m_nextObject;
 
-	void animate()
+	// Prevent copying or assigning GraphObjects
+	GraphObject(const GraphObject&) = delete;
+	GraphObject& operator=(const GraphObject&) = delete;
+};
+
+  // Every GraphObject in one world, by depth. Objects link themselves in and out,
+  // so creating and destroying one never allocates, and worlds don't share
+  // anything: each can create, move and destroy objects on its own thread.
+
+class GraphObjectRegistry
+{
+public:
+	GraphObjectRegistry()
+		: m_lists()	// all empty
 	{
-		m_x = m_destX;
-		m_y = m_destY;
-		// moveALittle(m_x, m_destX);
-		// moveALittle(m_y, m_destY);
 	}
 
-	void moveALittle(double& from, double& to)
+	  // Call before each simulation tick: whatever moves during the tick
+	  // is then drawn sliding from where it is now to where the tick leaves it.
+	void startTick()
 	{
-		static const double DISTANCE = 1.0 / ANIMATION_POSITIONS_PER_TICK;
-		if (to - from >= DISTANCE)
-			from += DISTANCE;
-		else if (from - to >= DISTANCE)
-			from -= DISTANCE;
-		else
-			from = to;
+		for (int depth = 0; depth < NUM_DEPTHS; depth++)
+			for (GraphObject* go = m_lists[depth].first; go != nullptr; go = go->m_nextObject)
+			{
+				go->m_x = go->m_destX;
+				go->m_y = go->m_destY;
+			}
 	}
 
-	static std::set<GraphObject*>& getGraphObjects(int depth)
+	  // alpha is how far between the previous tick (0) and the latest one (1) to draw things
+	template<typename Func>
+	void drawAllObjects(Func plotFunc, double alpha = 1) const
 	{
-		static std::set<GraphObject*> m_graphObjects[NUM_DEPTHS];
-		if (depth < NUM_DEPTHS)
-			return m_graphObjects[depth];
+		for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--)
+		{
+			for (const GraphObject* go = m_lists[depth].first; go != nullptr; go = go->m_nextObject)
+			{
+				double x = go->m_x + (go->m_destX - go->m_x) * alpha;
+				double y = go->m_y + (go->m_destY - go->m_y) * alpha;
+				plotFunc(go->m_imageID, go->m_animationNumber, x, y, go->m_direction, go->m_size);
+			}
+		}
+	}
+
+private:
+	friend class GraphObject;
+
+	static const int NUM_DEPTHS = 4;
+
+	struct ObjectList
+	{
+		GraphObject* first;
+		GraphObject* last;
+
+		void append(GraphObject* go)
+		{
+			go->m_prevObject = last;
+			go->m_nextObject = nullptr;
+			if (last != nullptr)
+				last->m_nextObject = go;
+			else
+				first = go;
+			last = go;
+		}
+
+		void remove(GraphObject* go)
+		{
+			if (go->m_prevObject != nullptr)
+				go->m_prevObject->m_nextObject = go->m_nextObject;
+			else
+				first = go->m_nextObject;
+			if (go->m_nextObject != nullptr)
+				go->m_nextObject->m_prevObject = go->m_prevObject;
+			else
+				last = go->m_prevObject;
+		}
+	};
+
+	ObjectList m_lists[NUM_DEPTHS];
+
+	ObjectList& listFor(int depth)
+	{
+		if (depth >= 0 && depth < NUM_DEPTHS)
+			return m_lists[depth];
 		else
-			return m_graphObjects[0];         // empty;
+			return m_lists[0];
 	}
 
-	// Prevent copying or assigning GraphObjects
-	GraphObject(const GraphObject&) = delete;
-	GraphObject& operator=(const GraphObject&) = delete;
+	// Prevent copying or assigning GraphObjectRegistries
+	GraphObjectRegistry(const GraphObjectRegistry&) = delete;
+	GraphObjectRegistry& operator=(const GraphObjectRegistry&) = delete;
 };
 
+inline GraphObject::GraphObject(GraphObjectRegistry& registry, int imageID, double startX, double startY, int dir, double size, int depth)
+	: m_registry(&registry), m_imageID(imageID), m_animationNumber(0), m_x(startX), m_y(startY),
+	m_destX(startX), m_destY(startY), m_direction(dir),
+	m_size(size <= 0 ? 1 : size), m_depth(depth)
+{
+	m_registry->listFor(m_depth).append(this);
+}
+
+inline GraphObject::~GraphObject()
+{
+	m_registry->listFor(m_depth).remove(this);
+}
+
 #endif // GRAPHOBJ_H_
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include "HeadlessDriver.h"
+#include "StudentWorld.h"
+#include "GameConstants.h"
+#include "Replay.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cstdint>
+using namespace std;
+
+// setRewindCheck: ticks between checks, and how many ticks of the world to keep for comparing
+const unsigned long REWIND_CHECK_INTERVAL = 97;
+const unsigned long REWIND_CHECK_HISTORY = 1024;
+const unsigned long REWIND_CHECK_REPLAY = 48;	// the most ticks a real rewind goes back and plays again
+const int NO_KEY = -1;	// m_keyLog: no key was handed out on that tick
+
+HeadlessDriver::HeadlessDriver(string assetDir)
+	: m_assetDir(assetDir), m_world(nullptr), m_threadPool(nullptr), m_snapshotEveryTick(false), m_snapshots(0), m_recording(nullptr), m_levels(nullptr), m_input(nullptr), m_hashLog(nullptr),
+	  m_rewindBudget(DEFAULT_REWIND_BYTES), m_rewindCheck(false), m_replayUntil(0), m_replayFrom(0), m_replayOldest(0), m_replaying(false),
+	  m_tick(0), m_sounds(0), m_quit(false)
+{
+}
+
+HeadlessDriver::~HeadlessDriver()
+{
+	endGame();
+}
+
+void HeadlessDriver::setKeySource(KeySource source)
+{
+	m_keySource = source;
+}
+
+void HeadlessDriver::setThreadPool(ThreadPool* pool)
+{
+	m_threadPool = pool;
+}
+
+void HeadlessDriver::setSnapshotEveryTick(bool on)
+{
+	m_snapshotEveryTick = on;
+}
+
+void HeadlessDriver::setRewindBudget(size_t bytes)
+{
+	m_rewindBudget = bytes;
+}
+
+void HeadlessDriver::setHashLog(ostream* out)
+{
+	m_hashLog = out;
+}
+
+void HeadlessDriver::setRewindCheck(bool on)
+{
+	m_rewindCheck = on;
+}
+
+void HeadlessDriver::setRecording(Replay* replay)
+{
+	m_recording = replay;
+}
+
+void HeadlessDriver::setLevels(const LevelSchedule* levels)
+{
+	m_levels = levels;
+}
+
+void HeadlessDriver::setInput(InputSource* input)
+{
+	m_input = input;
+}
+
+HeadlessResult HeadlessDriver::runGame(unsigned long maxTicks, uint64_t seed)
+{
+	startGame(seed);
+	m_world->setRecording(m_recording);
+	auto start = chrono::steady_clock::now();
+	int status = m_world->init();
+	if (!playUntil(status, maxTicks))
+		m_quit = true;
+	return endPlay(status, start);
+}
+
+HeadlessResult HeadlessDriver::playReplay(Replay& replay, unsigned long seekTick)
+{
+	startGame(replay.getSeed());
+	m_world->setPlayback(&replay, seekTick);
+	auto start = chrono::steady_clock::now();
+	int status = m_world->init();	// lands on the last keyframe at or before seekTick
+	m_tick = m_world->getTick();
+	unsigned long startTick = m_tick;
+	bool over = (seekTick > m_tick && playUntil(status, seekTick));
+	double seekSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	if (!over && !playUntil(status, replay.getTicks()))
+		m_quit = true;	// the recording was cut off here
+	HeadlessResult result = endPlay(status, start);
+	result.startTick = startTick;
+	result.seekSeconds = seekSeconds;
+	return result;
+}
+
+void HeadlessDriver::startGame(uint64_t seed)
+{
+	if (m_world != nullptr)
+		m_world->reset(seed);	// reuse the last game's world and everything it has allocated
+	else
+	{
+		m_world = new StudentWorld(m_assetDir, seed);
+		m_world->setController(this);
+		m_world->setProfiler(&m_profiler);
+	}
+	m_world->setThreadPool(m_threadPool);
+	m_world->setRewindBudget(m_rewindBudget);
+	m_world->setLevels(m_levels);
+	m_world->setInput(m_input);
+	m_tick = 0;
+	m_sounds = 0;
+	m_quit = false;
+	m_snapshots = 0;
+	m_snapshotTime = chrono::steady_clock::duration(0);
+	m_rewinds = 0;
+	m_rewindFailed = false;
+	m_rewindTime = chrono::steady_clock::duration(0);
+	m_rewindMaxTime = chrono::steady_clock::duration(0);
+	m_replayTime = chrono::steady_clock::duration(0);
+	m_history.resize(m_rewindCheck ? REWIND_CHECK_HISTORY : 0);
+	m_keyLog.assign(m_rewindCheck ? REWIND_CHECK_HISTORY : 0, NO_KEY);
+	m_replayUntil = 0;
+	m_replaying = false;
+}
+
+// mirrors the makemove/contgame/finishedlevel/cleanup/init states of GameController::doSomething,
+// minus the prompts and animation frames
+bool HeadlessDriver::playUntil(int& status, unsigned long maxTicks)
+{
+	while (status != GWSTATUS_PLAYER_WON && status != GWSTATUS_LEVEL_ERROR)
+	{
+		m_replaying = (m_world->getTick() < m_replayUntil);
+		if (m_replaying)	// after checkRewind rewound for real: this tick must go just as it did the first time
+		{
+			auto before = chrono::steady_clock::now();
+			m_world->saveSnapshot(m_rewindSnapshot);
+			bool same = (m_rewindSnapshot.bytes == m_history[m_world->getTick() % REWIND_CHECK_HISTORY].bytes);
+			status = m_world->move();
+			m_replayTime += chrono::steady_clock::now() - before;
+			if (!same || !checkReplayedTick())
+			{
+				m_rewindFailed = true;
+				m_quit = true;
+				return true;
+			}
+		}
+		else
+		{
+			if (m_tick >= maxTicks)
+				return false;
+			if (m_rewindCheck)
+			{
+				m_world->saveSnapshot(m_history[m_world->getTick() % REWIND_CHECK_HISTORY]);
+				m_keyLog[m_world->getTick() % REWIND_CHECK_HISTORY] = NO_KEY;
+			}
+			status = m_world->move();
+			m_tick++;
+			if (m_hashLog != nullptr)
+				*m_hashLog << m_world->getSeed() << ' ' << m_world->getTick() << ' '
+						   << hex << setw(16) << setfill('0') << m_world->getStateHash() << dec << '\n';
+		}
+		if (m_quit)
+			return true;
+		if (m_snapshotEveryTick && status == GWSTATUS_CONTINUE_GAME)
+		{
+			auto before = chrono::steady_clock::now();
+			m_world->saveSnapshot(m_snapshot);
+			bool loaded = m_world->loadSnapshot(m_snapshot);
+			m_snapshotTime += chrono::steady_clock::now() - before;
+			m_snapshots++;
+			if (!loaded)	// can't happen unless saving and loading disagree
+			{
+				m_quit = true;
+				return true;
+			}
+		}
+		if (m_rewindCheck && !m_replaying && status == GWSTATUS_CONTINUE_GAME && m_tick % REWIND_CHECK_INTERVAL == 0 && !checkRewind())
+		{
+			m_rewindFailed = true;
+			m_quit = true;
+			return true;
+		}
+		if (status == GWSTATUS_PLAYER_DIED)
+		{
+			m_world->cleanUp();
+			if (m_world->isGameOver())
+				return true;
+			status = m_world->init();
+		}
+		else if (status == GWSTATUS_FINISHED_LEVEL)
+		{
+			m_world->advanceToNextLevel();
+			m_world->cleanUp();
+			status = m_world->init();
+		}
+	}
+	return true;
+}
+
+// rewinds to a tick picked from the buffer's window (and our history), compares the world with how
+// it was then, then loads the present back, leaving the buffer as it was. Then it rewinds the world
+// for real, up to REWIND_CHECK_REPLAY ticks, for playUntil to play them again with the keys from
+// m_keyLog; the buffer must now end just before the tick rewound to.
+bool HeadlessDriver::checkRewind()
+{
+	const RewindBuffer& buffer = m_world->getRewindBuffer();
+	if (buffer.empty())
+		return true;
+	unsigned long newest = buffer.getNewestTick();
+	unsigned long oldest = max(buffer.getOldestTick(), newest + 1 - min<unsigned long>(newest + 1, REWIND_CHECK_HISTORY));
+	unsigned long tick = oldest + (m_tick * 7919) % (newest - oldest + 1);
+
+	m_world->saveSnapshot(m_snapshot);
+	auto before = chrono::steady_clock::now();
+	bool ok = buffer.reconstruct(tick, m_rewindFrame) && m_world->loadFrame(m_rewindFrame);
+	chrono::steady_clock::duration took = chrono::steady_clock::now() - before;
+	m_rewindTime += took;
+	m_rewindMaxTime = max(m_rewindMaxTime, took);
+	m_rewinds++;
+	WorldSnapshot& expected = m_history[tick % REWIND_CHECK_HISTORY];
+	if (ok)
+	{
+		m_world->saveSnapshot(m_rewindSnapshot);
+		ok = (m_rewindSnapshot.bytes == expected.bytes);
+	}
+	if (!m_world->loadSnapshot(m_snapshot) || !ok)
+		return false;
+
+	unsigned long present = m_world->getTick();
+	unsigned long back = 1 + (m_tick * 31) % REWIND_CHECK_REPLAY;
+	if (m_recording != nullptr || present < buffer.getOldestTick() + back)	// the world won't rewind while recording
+		return true;
+	m_replayOldest = buffer.getOldestTick();
+	m_replayFrom = present - back;
+	m_replayUntil = present;
+	if (!m_world->rewindTo(m_replayFrom))
+		return false;
+	return buffer.empty() ? m_replayFrom == m_replayOldest : buffer.getNewestTick() == m_replayFrom - 1;
+}
+
+// after the first tick played again, the buffer must carry on from where the rewind left it rather
+// than starting afresh (unless its budget only has room for the ticks since the rewind)
+bool HeadlessDriver::checkReplayedTick()
+{
+	const RewindBuffer& buffer = m_world->getRewindBuffer();
+	if (m_world->getTick() != m_replayFrom + 1)
+		return true;
+	if (buffer.empty() || buffer.getNewestTick() != m_replayFrom)
+		return false;
+	return m_replayFrom < m_replayOldest + 2 * REWIND_KEYFRAME_INTERVAL || buffer.getOldestTick() < m_replayFrom;
+}
+
+HeadlessResult HeadlessDriver::endPlay(int status, chrono::steady_clock::time_point start)
+{
+	m_world->cleanUp();
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start - m_snapshotTime - m_rewindTime - m_replayTime;
+
+	HeadlessResult result;
+	result.status = status;
+	result.ticks = m_tick;
+	result.startTick = 0;
+	result.level = m_world->getLevel();
+	result.score = m_world->getScore();
+	result.lives = m_world->getLives();
+	result.seed = m_world->getSeed();
+	result.runHash = m_world->getRunHash();
+	result.sounds = m_sounds;
+	result.quit = m_quit;
+	result.seconds = elapsed.count();
+	result.seekSeconds = 0;
+	result.snapshots = m_snapshots;
+	result.snapshotSeconds = chrono::duration<double>(m_snapshotTime).count();
+	result.snapshotBytes = m_snapshot.bytes.size();
+	result.rewinds = m_rewinds;
+	result.rewindSeconds = chrono::duration<double>(m_rewindTime).count();
+	result.rewindMaxSeconds = chrono::duration<double>(m_rewindMaxTime).count();
+	result.rewindFailed = m_rewindFailed;
+	const RewindBuffer& buffer = m_world->getRewindBuffer();
+	result.rewindBytes = buffer.getBytes();
+	result.rewindTicks = (buffer.empty() ? 0 : buffer.getNewestTick() - buffer.getOldestTick() + 1);
+	return result;
+}
+
+HeadlessDriver::KeySource HeadlessDriver::randomKeys(unsigned int seed)
+{
+	static const int keys[] = {
+		KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_LEFT, KEY_PRESS_RIGHT,
+		KEY_PRESS_SPACE, KEY_PRESS_SPACE, KEY_PRESS_TAB
+	};
+	const int nKeys = sizeof(keys) / sizeof(keys[0]);
+	minstd_rand generator(seed);
+	return [=](unsigned long, int& key) mutable
+	{
+		int pick = generator() % (2 * nKeys);	// about half the ticks press nothing
+		if (pick >= nKeys)
+			return false;
+		key = keys[pick];
+		return true;
+	};
+}
+
+bool HeadlessDriver::getLastKey(int& value)
+{
+	if (m_replaying)	// the same key as the first time round
+	{
+		value = m_keyLog[m_world->getTick() % REWIND_CHECK_HISTORY];
+		return value != NO_KEY;
+	}
+	if (!m_keySource || !m_keySource(m_tick, value))
+		return false;
+	if (m_rewindCheck)
+		m_keyLog[m_world->getTick() % REWIND_CHECK_HISTORY] = value;
+	return true;
+}
+
+void HeadlessDriver::playSound(int soundID)
+{
+	if (soundID != SOUND_NONE && !m_replaying)
+		m_sounds++;
+}
+
+void HeadlessDriver::setGameStatText(string_view text)
+{
+	m_gameStatText.assign(text);
+}
+
+void HeadlessDriver::quitGame()
+{
+	m_quit = true;
+}
+
+void HeadlessDriver::endGame()
+{
+	delete m_world;		// StudentWorld's destructor cleans up anything left over
+	m_world = nullptr;
+}
@@ -0,0 +1,150 @@
+#ifndef HEADLESSDRIVER_H_
+#define HEADLESSDRIVER_H_
+
+#include "GameWorld.h"
+#include "WorldSnapshot.h"
+#include "RewindBuffer.h"
+#include "TickProfiler.h"
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <functional>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+class StudentWorld;
+class ThreadPool;
+class Replay;
+class LevelSchedule;
+class InputSource;
+
+  // Result of playing one game without a window
+
+struct HeadlessResult
+{
+	int				status;		// GWSTATUS_* of the last tick (PLAYER_DIED on game over)
+	unsigned long	ticks;		// number of calls to move() (for playReplay, the world's tick count at the end)
+	unsigned long	startTick;	// playReplay: the keyframe it started from; otherwise 0
+	unsigned int	level;		// level the game ended on
+	unsigned int	score;
+	unsigned int	lives;
+	std::uint64_t	seed;		// world seed the game was played with
+	std::uint64_t	runHash;	// StudentWorld::getRunHash at the end: equal if the games were the same
+	unsigned long	sounds;		// sounds the world asked us to play
+	bool			quit;		// true if the world asked to quit (or we hit the tick limit)
+	double			seconds;	// wall clock time spent in init/move/cleanUp
+	double			seekSeconds;	// playReplay: part of that spent getting to seekTick
+	unsigned long	rewinds;	// rewinds checked (see setRewindCheck)
+	double			rewindSeconds;	// ... and the time they took, not counted in seconds
+	double			rewindMaxSeconds;	// the slowest one
+	bool			rewindFailed;	// one didn't match, so the game was stopped there
+	std::size_t		rewindBytes;	// memory the rewind buffer held at the end
+	unsigned long	rewindTicks;	// ... and how many ticks back it went
+	unsigned long	snapshots;	// round trips through a WorldSnapshot (see setSnapshotEveryTick)
+	double			snapshotSeconds;	// ... and the time they took, not counted in seconds
+	std::size_t		snapshotBytes;	// size of the last one
+};
+
+  // Drives a StudentWorld the way GameController does, but with no GLUT window,
+  // no frame timer and no sound: init()/move()/cleanUp() run back to back as
+  // fast as the CPU allows. Keys come from a KeySource instead of the keyboard,
+  // unless an InputSource (a bot, say) is set to play instead.
+
+class HeadlessDriver : public GameHost
+{
+public:
+	  // Called once per key poll; return true and set key to "press" something
+	using KeySource = std::function<bool(unsigned long tick, int& key)>;
+
+	HeadlessDriver(std::string assetDir = "");
+	virtual ~HeadlessDriver();
+
+	void setKeySource(KeySource source);
+	void setThreadPool(ThreadPool* pool);	// handed to every world this plays (nullptr: single threaded)
+	void setSnapshotEveryTick(bool on);	// save and reload the world after every tick; the game mustn't change
+	void setRewindBudget(std::size_t bytes);	// for every world this plays (default DEFAULT_REWIND_BYTES)
+	void setHashLog(std::ostream* out);	// writes "seed tick hash" after every tick (nullptr: don't)
+	  // now and then rewind to a recent tick, check the world is as it was then, and come back; then
+	  // really rewind the world a little way and play those ticks again, with the same keys, checking
+	  // each is as it was the first time and that the rewind buffer still reaches back past them
+	void setRewindCheck(bool on);
+	void setRecording(Replay* replay);	// record every game runGame plays into replay (nullptr: don't)
+	void setLevels(const LevelSchedule* levels);	// for every world this plays (nullptr: random levels)
+	void setInput(InputSource* input);	// for every world this plays (nullptr: the KeySource's keys)
+	HeadlessResult runGame(unsigned long maxTicks, std::uint64_t seed);	// plays one fresh game until it ends or maxTicks
+
+	  // plays a recorded game back at full speed, from its last keyframe at or before seekTick
+	  // up to where the recording ended; the result should match the recording's
+	HeadlessResult playReplay(Replay& replay, unsigned long seekTick = 0);
+
+	static KeySource randomKeys(unsigned int seed);	// mashes movement/fire keys, for soak tests
+
+	  // GameHost
+	virtual bool getLastKey(int& value);
+	virtual void playSound(int soundID);
+	virtual void setGameStatText(std::string_view text);
+	virtual void quitGame();
+
+	StudentWorld* getWorld() const	// world of the last game played (nullptr before the first)
+	{
+		return m_world;
+	}
+
+	const std::string& getGameStatText() const
+	{
+		return m_gameStatText;
+	}
+
+	TickProfiler& getProfiler()	// timings of every world this has played (NB_PROFILE builds)
+	{
+		return m_profiler;
+	}
+
+private:
+	std::string		m_assetDir;
+	StudentWorld*	m_world;
+	KeySource		m_keySource;
+	ThreadPool*		m_threadPool;
+	bool			m_snapshotEveryTick;
+	WorldSnapshot	m_snapshot;
+	unsigned long	m_snapshots;
+	std::chrono::steady_clock::duration m_snapshotTime;
+	Replay*			m_recording;
+	const LevelSchedule* m_levels;
+	InputSource*	m_input;
+	std::ostream*	m_hashLog;
+	std::size_t		m_rewindBudget;
+	bool			m_rewindCheck;
+	std::vector<WorldSnapshot> m_history;	// setRewindCheck: the world before each of the last few ticks
+	std::vector<int> m_keyLog;	// ... and the key handed out on each (NO_KEY for none)
+	unsigned long	m_replayUntil;	// after a real rewind: world tick at which we're back where we were
+	unsigned long	m_replayFrom;	// ... the tick we rewound to
+	unsigned long	m_replayOldest;	// ... and the oldest tick in the buffer before that
+	bool			m_replaying;	// playing ticks again; they don't count towards ticks, sounds or the hash log
+	std::chrono::steady_clock::duration m_replayTime;	// ... or towards seconds
+	WorldFrame		m_rewindFrame;
+	WorldSnapshot	m_rewindSnapshot;
+	unsigned long	m_rewinds;
+	bool			m_rewindFailed;
+	std::chrono::steady_clock::duration m_rewindTime;
+	std::chrono::steady_clock::duration m_rewindMaxTime;
+	std::string		m_gameStatText;
+	TickProfiler	m_profiler;
+	unsigned long	m_tick;
+	unsigned long	m_sounds;
+	bool			m_quit;
+
+	bool checkRewind();	// false if the rewound world wasn't what it had been
+	bool checkReplayedTick();	// false if a tick played again after a real rewind didn't match
+	void startGame(std::uint64_t seed);	// a fresh world (the last one, reset), not yet initialized
+	bool playUntil(int& status, unsigned long maxTicks);	// false if it stopped at maxTicks rather than the end of the game
+	HeadlessResult endPlay(int status, std::chrono::steady_clock::time_point start);
+	void endGame();
+
+	// Prevent copying or assigning HeadlessDrivers
+	HeadlessDriver(const HeadlessDriver&) = delete;
+	HeadlessDriver& operator=(const HeadlessDriver&) = delete;
+};
+
+#endif // HEADLESSDRIVER_H_
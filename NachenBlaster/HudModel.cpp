@@ -0,0 +1,59 @@
+#include "HudModel.h"
+#include <charconv>
+#include <cstring>
+using namespace std;
+
+enum HudField
+{
+	HUD_LIVES, HUD_HEALTH, HUD_SCORE, HUD_LEVEL, HUD_CABBAGES, HUD_TORPEDOES
+};
+
+HudModel::HudModel()
+	: m_fields(), m_formatted(false), m_length(0)
+{
+	m_text[0] = '\0';
+}
+
+bool HudModel::update(int lives, int healthPercent, int score, int level, int cabbagePercent, int torpedoes)
+{
+	const int fields[NUM_FIELDS] = { lives, healthPercent, score, level, cabbagePercent, torpedoes };
+	if (m_formatted && memcmp(fields, m_fields, sizeof(fields)) == 0)
+		return false;
+	memcpy(m_fields, fields, sizeof(fields));
+	format();
+	m_formatted = true;
+	return true;
+}
+
+// "Lives: 3   Health: 100%   Score: 0   Level: 1   Cabbages: 100%   Torpedoes: 0"
+void HudModel::format()
+{
+	char* p = m_text;
+	char* end = m_text + TEXT_CAPACITY;
+	auto text = [&](const char* s)
+	{
+		size_t n = strlen(s);
+		memcpy(p, s, n);
+		p += n;
+	};
+	auto number = [&](int value)
+	{
+		p = to_chars(p, end, value).ptr;
+	};
+
+	text("Lives: ");
+	number(m_fields[HUD_LIVES]);
+	text("   Health: ");
+	number(m_fields[HUD_HEALTH]);
+	text("%   Score: ");
+	number(m_fields[HUD_SCORE]);
+	text("   Level: ");
+	number(m_fields[HUD_LEVEL]);
+	text("   Cabbages: ");
+	if (m_fields[HUD_CABBAGES] >= 0 && m_fields[HUD_CABBAGES] < 10)	// always two digits, so the line doesn't jitter
+		text("0");
+	number(m_fields[HUD_CABBAGES]);
+	text("%   Torpedoes: ");
+	number(m_fields[HUD_TORPEDOES]);
+	m_length = static_cast<int>(p - m_text);
+}
@@ -0,0 +1,36 @@
+#ifndef HUDMODEL_H_
+#define HUDMODEL_H_
+
+#include <string_view>
+
+  // The status line along the top of the screen. It keeps the numbers it was last
+  // formatted with and only rewrites its text when one of them changes, in place in
+  // a fixed buffer, so an ordinary tick neither formats nor allocates anything.
+
+class HudModel
+{
+public:
+	HudModel();
+
+	  // true if anything changed since the last call (or this is the first), in which
+	  // case getText() has the new line
+	bool update(int lives, int healthPercent, int score, int level, int cabbagePercent, int torpedoes);
+
+	std::string_view getText() const	// valid until the next update that returns true
+	{
+		return std::string_view(m_text, m_length);
+	}
+
+private:
+	static const int NUM_FIELDS = 6;
+	static const int TEXT_CAPACITY = 160;	// the labels plus six numbers of up to 11 characters each
+
+	int		m_fields[NUM_FIELDS];
+	bool	m_formatted;
+	char	m_text[TEXT_CAPACITY];
+	int		m_length;
+
+	void format();
+};
+
+#endif // HUDMODEL_H_
@@ -0,0 +1,168 @@
+#include "InputSource.h"
+#include "StudentWorld.h"
+#include "Actor.h"
+#include "Replay.h"
+#include "GameConstants.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+///////////////////////////////////
+// KeyboardInput
+///////////////////////////////////
+
+bool KeyboardInput::nextAction(const StudentWorld& world, PlayerAction& action)
+{
+	int key;
+	if (!world.getController()->getLastKey(key))
+		return false;
+	action = PlayerAction::fromKey(key);
+	return true;
+}
+
+///////////////////////////////////
+// ReplayInput
+///////////////////////////////////
+
+ReplayInput::ReplayInput(Replay* replay)
+	: m_replay(replay)
+{
+}
+
+void ReplayInput::setReplay(Replay* replay)
+{
+	m_replay = replay;
+}
+
+bool ReplayInput::nextAction(const StudentWorld& world, PlayerAction& action)
+{
+	return m_replay != nullptr && m_replay->nextAction(world.getTick(), action);
+}
+
+///////////////////////////////////
+// ScriptedInput
+///////////////////////////////////
+
+void ScriptedInput::add(unsigned long tick, const PlayerAction& action)
+{
+	Step step = { tick, action };
+	m_steps.push_back(step);
+}
+
+bool ScriptedInput::load(const string& path, string& error)
+{
+	ifstream in(path);
+	if (!in)
+	{
+		error = "can't read " + path;
+		return false;
+	}
+	vector<Step> steps;
+	string line;
+	for (int lineNumber = 1; getline(in, line); lineNumber++)
+	{
+		auto fail = [&](const string& what)
+		{
+			error = path + ":" + to_string(lineNumber) + ": " + what;
+			return false;
+		};
+		line = line.substr(0, line.find('#'));
+		istringstream words(line);
+		string word;
+		if (!(words >> word))
+			continue;
+		if (word.empty() || word.size() > 9 || word.find_first_not_of("0123456789") != string::npos)
+			return fail("expected a tick, not '" + word + "'");
+		Step step = { stoul(word), PlayerAction::unpack(0) };
+		if (!steps.empty() && step.tick <= steps.back().tick)
+			return fail("ticks must go up");
+		uint32_t bits = 0;
+		while (words >> word)
+		{
+			if (word == "up")			bits |= PlayerAction::UP;
+			else if (word == "down")	bits |= PlayerAction::DOWN;
+			else if (word == "left")	bits |= PlayerAction::LEFT;
+			else if (word == "right")	bits |= PlayerAction::RIGHT;
+			else if (word == "fire")	bits |= PlayerAction::FIRE;
+			else if (word == "torpedo")	bits |= PlayerAction::TORPEDO;
+			else if (word != "none")
+				return fail("unknown action '" + word + "' (up, down, left, right, fire, torpedo or none)");
+		}
+		step.action = PlayerAction::unpack(bits);
+		steps.push_back(step);
+	}
+	m_steps.swap(steps);
+	return true;
+}
+
+bool ScriptedInput::nextAction(const StudentWorld& world, PlayerAction& action)
+{
+	unsigned long tick = world.getTick();
+	vector<Step>::const_iterator p = upper_bound(m_steps.begin(), m_steps.end(), tick,
+		[](unsigned long t, const Step& step) { return t < step.tick; });
+	if (p == m_steps.begin())
+		return false;	// before the first step
+	action = (p - 1)->action;
+	return true;
+}
+
+///////////////////////////////////
+// BotInput
+///////////////////////////////////
+
+// how far ahead (in pixels) the bot looks for things about to hit it, and how
+// close in height counts as in line with it
+const double BOT_DANGER_RANGE = 72;
+const double BOT_DANGER_HEIGHT = 20;
+const double BOT_AIM_HEIGHT = 8;
+
+bool BotInput::nextAction(const StudentWorld& world, PlayerAction& action)
+{
+	const NachenBlaster* user = world.getUser();
+	if (user == nullptr)
+		return false;
+	double ux = user->getX(), uy = user->getY();
+
+	const Actor* target = nullptr;
+	double targetDistance = 0;
+	const Actor* danger = nullptr;
+	world.forEachActor([&](const Actor* actor)
+	{
+		if (!actor->isAlive() || actor->getX() < ux)
+			return;
+		double dx = actor->getX() - ux, dy = actor->getY() - uy;
+		if ((isAlien(actor) || isEnemyProjectile(actor)) && dx < BOT_DANGER_RANGE && fabs(dy) < BOT_DANGER_HEIGHT &&
+			(danger == nullptr || dx < danger->getX() - ux))
+			danger = actor;
+		if (isAlien(actor) && (target == nullptr || dx + 2 * fabs(dy) < targetDistance))	// height costs more to close
+		{
+			target = actor;
+			targetDistance = dx + 2 * fabs(dy);
+		}
+	});
+
+	action = PlayerAction::unpack(0);
+	if (danger != nullptr)	// get out of its way, towards whichever side has more room
+	{
+		bool up = (danger->getY() < uy || (danger->getY() == uy && uy < VIEW_HEIGHT / 2));
+		action.dy = (up ? 1 : -1);
+		action.dx = -1;
+	}
+	else if (target != nullptr && fabs(target->getY() - uy) >= BOT_AIM_HEIGHT / 2)
+		action.dy = (target->getY() > uy ? 1 : -1);
+	if (danger == nullptr && ux < VIEW_WIDTH / 8)	// stay near the left, with room to back off
+		action.dx = 1;
+	else if (danger == nullptr && ux > VIEW_WIDTH / 4)
+		action.dx = -1;
+
+	if (target != nullptr && fabs(target->getY() - uy) < BOT_AIM_HEIGHT)
+	{
+		action.fire = (user->getCabbageEnergy() >= 5);
+		action.torpedo = (target->getKind() == KIND_SNAGGLEGON && user->getNOfTorpedoes() > 0);
+	}
+	return true;
+}
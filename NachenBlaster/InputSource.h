@@ -0,0 +1,95 @@
+#ifndef INPUTSOURCE_H_
+#define INPUTSOURCE_H_
+
+#include "PlayerAction.h"
+#include <string>
+#include <vector>
+
+class StudentWorld;
+class Replay;
+
+  // Where the user's ship gets its actions: asked once per tick the ship is alive,
+  // on the world's own thread, in the middle of the tick. StudentWorld::setInput
+  // picks one; by default it's the keyboard. Sources that keep no state of their
+  // own (ScriptedInput, BotInput) can drive any number of worlds at once.
+
+class InputSource
+{
+public:
+	virtual ~InputSource()
+	{
+	}
+
+	  // this tick's action (for world.getTick()); false to do nothing
+	virtual bool nextAction(const StudentWorld& world, PlayerAction& action) = 0;
+};
+
+  // The keys the world's host hands it, one per tick: the keyboard in a window,
+  // the HeadlessDriver's KeySource without one
+
+class KeyboardInput : public InputSource
+{
+public:
+	virtual bool nextAction(const StudentWorld& world, PlayerAction& action);
+};
+
+  // A recorded game's actions, on the ticks they were recorded on; quits once the
+  // recording runs out. StudentWorld::setPlayback uses one of these.
+
+class ReplayInput : public InputSource
+{
+public:
+	ReplayInput(Replay* replay = nullptr);
+	void setReplay(Replay* replay);
+	virtual bool nextAction(const StudentWorld& world, PlayerAction& action);
+
+private:
+	Replay* m_replay;
+};
+
+  // A fixed script: from each step's tick on, the same action every tick until the
+  // next step. The text form has one step per line, a tick then what to do, with
+  // '#' starting a comment:
+  //
+  //     0    right
+  //     40   up fire
+  //     90   none
+  //     120  down left torpedo
+  //
+  // The words are up, down, left, right, fire, torpedo and none.
+
+class ScriptedInput : public InputSource
+{
+public:
+	void add(unsigned long tick, const PlayerAction& action);	// after every step added so far
+	bool load(const std::string& path, std::string& error);	// false with error "file:line: what's wrong"
+
+	std::size_t size() const
+	{
+		return m_steps.size();
+	}
+
+	virtual bool nextAction(const StudentWorld& world, PlayerAction& action);
+
+private:
+	struct Step
+	{
+		unsigned long	tick;
+		PlayerAction	action;
+	};
+
+	std::vector<Step> m_steps;	// in tick order
+};
+
+  // A simple player that runs in-process at full simulation speed: it lines up with
+  // the nearest alien ahead, fires cabbages at it when it's in line, saves torpedoes
+  // for Snagglegons, and steps out of the way of anything about to run into it.
+  // It only reads the world, so it's a starting point for better bots.
+
+class BotInput : public InputSource
+{
+public:
+	virtual bool nextAction(const StudentWorld& world, PlayerAction& action);
+};
+
+#endif // INPUTSOURCE_H_
@@ -0,0 +1,221 @@
+#include "LevelSchedule.h"
+#include "WorldSnapshot.h"
+#include "GameConstants.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+// more than this in a file means it's corrupt (or a scenario nobody could play)
+const uint32_t MAX_LEVELS = 1 << 16;
+const uint32_t MAX_WAVES = 1 << 24;
+
+const size_t HEADER_SIZE = 4 * sizeof(uint32_t);
+
+LevelSchedule::LevelSchedule()
+	: m_nLevels(0), m_nWaves(0), m_levelsAt(0), m_wavesAt(0)
+{
+}
+
+bool LevelSchedule::open(const string& path)
+{
+	m_nLevels = 0;
+	if (!m_file.open(path))
+		return false;
+	SnapshotReader r(m_file.data(), m_file.size());
+	uint32_t magic = r.read<uint32_t>();
+	uint32_t version = r.read<uint32_t>();
+	uint32_t nLevels = r.read<uint32_t>();
+	uint32_t nWaves = r.read<uint32_t>();
+	if (r.failed() || magic != LEVELS_MAGIC || version != LEVELS_VERSION || nLevels == 0 ||
+		nLevels > MAX_LEVELS || nWaves > MAX_WAVES ||
+		m_file.size() != HEADER_SIZE + nLevels * sizeof(LevelInfo) + nWaves * sizeof(WaveSpawn))
+	{
+		m_file.close();
+		return false;
+	}
+	m_nWaves = nWaves;
+	m_levelsAt = HEADER_SIZE;
+	m_wavesAt = m_levelsAt + nLevels * sizeof(LevelInfo);
+
+	// check it all once here, so nothing has to be checked while the game is running
+	for (uint32_t i = 0; i < nLevels; i++)
+	{
+		LevelInfo level;
+		memcpy(&level, m_file.data() + m_levelsAt + i * sizeof(LevelInfo), sizeof(level));
+		bool ok = level.kills > 0 && level.maxOnScreen > 0 &&
+				  level.firstWave <= nWaves && level.nWaves <= nWaves - level.firstWave;
+		for (uint32_t w = 0; ok && w < level.nWaves; w++)
+		{
+			WaveSpawn wave = getWave(level.firstWave + w);
+			ok = wave.alien < NUM_WAVE_ALIENS && wave.lane < VIEW_HEIGHT &&
+				 (w == 0 || wave.tick >= getWave(level.firstWave + w - 1).tick);
+		}
+		if (!ok)
+		{
+			m_file.close();
+			return false;
+		}
+	}
+	m_nLevels = nLevels;
+	return true;
+}
+
+bool LevelSchedule::getLevel(unsigned int level, LevelInfo& info) const
+{
+	if (level == 0 || level > m_nLevels)
+		return false;
+	memcpy(&info, m_file.data() + m_levelsAt + (level - 1) * sizeof(LevelInfo), sizeof(info));
+	return true;
+}
+
+WaveSpawn LevelSchedule::getWave(uint32_t index) const
+{
+	WaveSpawn wave;
+	memcpy(&wave, m_file.data() + m_wavesAt + index * sizeof(WaveSpawn), sizeof(wave));
+	return wave;
+}
+
+///////////////////////////////////
+// Compiling
+///////////////////////////////////
+
+static bool parseAlien(const string& name, uint8_t& alien)
+{
+	static const char* const names[NUM_WAVE_ALIENS] = { "smallgon", "smoregon", "snagglegon" };
+	for (uint8_t i = 0; i < NUM_WAVE_ALIENS; i++)
+		if (name == names[i])
+		{
+			alien = i;
+			return true;
+		}
+	return false;
+}
+
+// a whole word that's a number no bigger than max
+static bool parseNumber(const string& word, unsigned long max, unsigned long& value)
+{
+	if (word.empty() || word.find_first_not_of("0123456789") != string::npos || word.size() > 9)
+		return false;
+	value = stoul(word);
+	return value <= max;
+}
+
+bool compileLevels(const string& textPath, const string& binaryPath, string& error)
+{
+	ifstream in(textPath);
+	if (!in)
+	{
+		error = "can't read " + textPath;
+		return false;
+	}
+	vector<LevelInfo> levels;
+	vector<vector<WaveSpawn>> waves;	// per level
+	unsigned long nWaves = 0;
+	string line;
+	for (int lineNumber = 1; getline(in, line); lineNumber++)
+	{
+		auto fail = [&](const string& what)
+		{
+			error = textPath + ":" + to_string(lineNumber) + ": " + what;
+			return false;
+		};
+		line = line.substr(0, line.find('#'));
+		istringstream words(line);
+		vector<string> w;
+		for (string word; words >> word; )
+			w.push_back(word);
+		if (w.empty())
+			continue;
+
+		unsigned long value;
+		if (w[0] == "level")
+		{
+			if (w.size() != 1)
+				return fail("'level' takes nothing after it");
+			if (levels.size() == MAX_LEVELS)
+				return fail("too many levels");
+			unsigned int n = levels.size() + 1;
+			LevelInfo level = { 6 + 4 * n, static_cast<uint32_t>(4 + .5 * n), 0, 0 };	// the same as without a schedule
+			levels.push_back(level);
+			waves.emplace_back();
+		}
+		else if (levels.empty())
+			return fail("'" + w[0] + "' before the first 'level'");
+		else if (w[0] == "kills" || w[0] == "onscreen")
+		{
+			if (w.size() != 2 || !parseNumber(w[1], MAX_WAVES, value) || value == 0)
+				return fail("'" + w[0] + "' needs a count from 1 to " + to_string(MAX_WAVES));
+			(w[0] == "kills" ? levels.back().kills : levels.back().maxOnScreen) = value;
+		}
+		else if (w[0] == "at")
+		{
+			if (w.size() < 4 || w.size() > 6)
+				return fail("expected 'at tick alien lane [count [interval]]'");
+			WaveSpawn wave;
+			unsigned long tick, count = 1, interval = 0;
+			if (!parseNumber(w[1], 100000000, tick))
+				return fail("bad tick '" + w[1] + "'");
+			if (!parseAlien(w[2], wave.alien))
+				return fail("unknown alien '" + w[2] + "' (smallgon, smoregon or snagglegon)");
+			wave.flags = 0;
+			wave.lane = 0;
+			if (w[3] == "random")
+				wave.flags |= WAVE_RANDOM_LANE;
+			else if (parseNumber(w[3], VIEW_HEIGHT - 1, value))
+				wave.lane = static_cast<uint16_t>(value);
+			else
+				return fail("lane must be 'random' or from 0 to " + to_string(VIEW_HEIGHT - 1));
+			if (w.size() > 4 && (!parseNumber(w[4], MAX_WAVES, count) || count == 0))
+				return fail("bad count '" + w[4] + "'");
+			if (w.size() > 5 && !parseNumber(w[5], 100000, interval))
+				return fail("bad interval '" + w[5] + "'");
+			if (nWaves + count > MAX_WAVES)
+				return fail("too many waves");
+			for (unsigned long i = 0; i < count; i++)
+			{
+				wave.tick = static_cast<uint32_t>(tick + i * interval);
+				waves.back().push_back(wave);
+			}
+			nWaves += count;
+		}
+		else
+			return fail("unknown directive '" + w[0] + "'");
+	}
+	if (levels.empty())
+	{
+		error = textPath + ": no levels";
+		return false;
+	}
+
+	WorldSnapshot file;	// just a byte buffer that knows how to write itself out
+	SnapshotWriter out(file.bytes);
+	out.write(LEVELS_MAGIC);
+	out.write(LEVELS_VERSION);
+	out.write(static_cast<uint32_t>(levels.size()));
+	out.write(static_cast<uint32_t>(nWaves));
+	uint32_t firstWave = 0;
+	for (unsigned int i = 0; i < levels.size(); i++)
+	{
+		// in tick order, keeping the written order for waves on the same tick
+		stable_sort(waves[i].begin(), waves[i].end(),
+			[](const WaveSpawn& a, const WaveSpawn& b) { return a.tick < b.tick; });
+		levels[i].firstWave = firstWave;
+		levels[i].nWaves = waves[i].size();
+		firstWave += levels[i].nWaves;
+		out.write(levels[i]);
+	}
+	for (const vector<WaveSpawn>& level : waves)
+		for (const WaveSpawn& wave : level)
+			out.write(wave);
+	if (!file.writeFile(binaryPath))
+	{
+		error = "can't write " + binaryPath;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,90 @@
+#ifndef LEVELSCHEDULE_H_
+#define LEVELSCHEDULE_H_
+
+#include "MappedFile.h"
+#include <string>
+#include <cstdint>
+
+  // Levels written ahead of time instead of rolled as the game goes. A text file
+  // like this (see Assets/levels.txt)
+  //
+  //     level                          # starts the next level
+  //     kills 20                       # aliens to destroy to finish it (default 6 + 4 * level)
+  //     onscreen 6                     # most aliens at once (default 4 + level / 2)
+  //     at 0 smallgon 128              # tick since the level began, alien, lane (y)
+  //     at 30 snagglegon random 10 5   # ... optionally how many, and the ticks between them
+  //
+  // is compiled with compileLevels into a binary wave schedule:
+  //
+  //     header      magic, version, level count, wave count
+  //     levels      kills, on screen cap, first wave, wave count      (16 bytes each)
+  //     waves       tick, alien, flags, lane, in tick order per level  (8 bytes each)
+  //
+  // which the game maps into memory and walks with a cursor, one level at a time.
+  // When a level's waves run out before enough aliens have been destroyed, the
+  // rest come at random as they would without a schedule. Finishing the last
+  // level wins the game.
+
+const std::uint32_t LEVELS_MAGIC = 0x564c424e;	// "NBLV"
+const std::uint32_t LEVELS_VERSION = 1;
+
+enum WaveAlien : std::uint8_t
+{
+	WAVE_SMALLGON, WAVE_SMOREGON, WAVE_SNAGGLEGON, NUM_WAVE_ALIENS
+};
+
+const std::uint8_t WAVE_RANDOM_LANE = 1;	// flag: pick the lane when it spawns, ignoring lane
+
+struct LevelInfo
+{
+	std::uint32_t kills;
+	std::uint32_t maxOnScreen;
+	std::uint32_t firstWave;	// index of its first wave in the schedule
+	std::uint32_t nWaves;
+};
+
+struct WaveSpawn
+{
+	std::uint32_t	tick;	// since the level began
+	std::uint8_t	alien;	// WaveAlien
+	std::uint8_t	flags;
+	std::uint16_t	lane;	// y, from 0 to VIEW_HEIGHT - 1
+};
+
+static_assert(sizeof(LevelInfo) == 16 && sizeof(WaveSpawn) == 8, "the level file layout has no padding");
+
+  // A compiled level file, mapped read-only; many worlds can share one
+
+class LevelSchedule
+{
+public:
+	LevelSchedule();
+
+	bool open(const std::string& path);	// false if it can't be mapped or isn't a valid level file
+
+	bool isOpen() const
+	{
+		return m_nLevels > 0;
+	}
+
+	unsigned int getLevelCount() const
+	{
+		return m_nLevels;
+	}
+
+	bool getLevel(unsigned int level, LevelInfo& info) const;	// level counts from 1; false past the last one
+	WaveSpawn getWave(std::uint32_t index) const;	// index from LevelInfo::firstWave on
+
+private:
+	MappedFile		m_file;
+	std::uint32_t	m_nLevels;
+	std::uint32_t	m_nWaves;
+	std::size_t		m_levelsAt;	// byte offsets of the two tables in the file
+	std::size_t		m_wavesAt;
+};
+
+  // Compiles a text level file into a binary one. On failure returns false and sets
+  // error to the first problem found, as "file:line: what's wrong".
+bool compileLevels(const std::string& textPath, const std::string& binaryPath, std::string& error);
+
+#endif // LEVELSCHEDULE_H_
@@ -0,0 +1,43 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+
+  // A whole file mapped read-only into memory. The OS pages it in as it's read
+  // and shares the pages between everything that maps the same file, so opening
+  // costs next to nothing however big the file is.
+
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string& path);	// false if it can't be opened, is empty, or can't be mapped
+	void close();
+
+	const unsigned char* data() const	// nullptr if nothing is open
+	{
+		return m_data;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+private:
+	const unsigned char*	m_data;
+	std::size_t				m_size;
+#ifdef _WIN32
+	void*					m_file;	// HANDLEs
+	void*					m_mapping;
+#endif
+
+	// Prevent copying or assigning MappedFiles
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif // MAPPEDFILE_H_
@@ -0,0 +1,116 @@
+#ifndef OBJECTPOOL_H_
+#define OBJECTPOOL_H_
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+
+  // Allocation counters for one pool
+
+struct PoolStats
+{
+	const char*			name;
+	unsigned long long	created;	// objects ever constructed in the pool
+	unsigned long long	reused;		// ... of which went into a slot freed earlier
+	unsigned int		live;		// objects currently in the pool
+	unsigned int		peakLive;
+	unsigned int		capacity;	// slots allocated so far (live + free)
+};
+
+  // Free-list pool for objects of type T. Slots are carved out of blocks that
+  // stay allocated until the pool is destroyed, so once a game has warmed up,
+  // creating and destroying objects never touches the heap.
+  // T only has to be complete where create() and destroy() are used.
+
+template<typename T>
+class ObjectPool
+{
+public:
+	explicit ObjectPool(const char* name = "", unsigned int slotsPerBlock = 32)
+		: m_freeList(nullptr), m_slotsPerBlock(slotsPerBlock), m_touched(0)
+	{
+		m_stats.name = name;
+		m_stats.created = 0;
+		m_stats.reused = 0;
+		m_stats.live = 0;
+		m_stats.peakLive = 0;
+		m_stats.capacity = 0;
+	}
+
+	~ObjectPool()	// everything created must have been destroyed by now
+	{
+		for (unsigned int i = 0; i < m_blocks.size(); i++)
+			::operator delete(m_blocks[i]);
+	}
+
+	template<typename... Args>
+	T* create(Args&&... args)
+	{
+		if (m_freeList == nullptr)
+			addBlock();
+		if (m_touched > m_stats.live)	// freed slots go on the front of the free list, so this is one of them
+			m_stats.reused++;
+		else
+			m_touched++;
+		FreeSlot* slot = m_freeList;
+		m_freeList = slot->next;
+		T* object = new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+		m_stats.created++;
+		if (++m_stats.live > m_stats.peakLive)
+			m_stats.peakLive = m_stats.live;
+		return object;
+	}
+
+	void destroy(T* object)
+	{
+		object->~T();
+		FreeSlot* slot = static_cast<FreeSlot*>(static_cast<void*>(object));
+		slot->next = m_freeList;
+		m_freeList = slot;
+		m_stats.live--;
+	}
+
+	const PoolStats& getStats() const
+	{
+		return m_stats;
+	}
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	static std::size_t slotSize()	// big enough and aligned for either a T or a FreeSlot
+	{
+		std::size_t size = (sizeof(T) > sizeof(FreeSlot) ? sizeof(T) : sizeof(FreeSlot));
+		std::size_t align = (alignof(T) > alignof(FreeSlot) ? alignof(T) : alignof(FreeSlot));
+		return (size + align - 1) / align * align;
+	}
+
+	void addBlock()
+	{
+		char* block = static_cast<char*>(::operator new(slotSize() * m_slotsPerBlock));
+		m_blocks.push_back(block);
+		for (unsigned int i = m_slotsPerBlock; i-- > 0; )	// so the block's first slot is used first
+		{
+			FreeSlot* slot = reinterpret_cast<FreeSlot*>(block + i * slotSize());
+			slot->next = m_freeList;
+			m_freeList = slot;
+		}
+		m_stats.capacity += m_slotsPerBlock;
+	}
+
+	std::vector<char*>	m_blocks;
+	FreeSlot*			m_freeList;
+	unsigned int		m_slotsPerBlock;
+	unsigned int		m_touched;	// slots ever handed out
+	PoolStats			m_stats;
+
+	// Prevent copying or assigning ObjectPools
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+};
+
+#endif // OBJECTPOOL_H_
@@ -0,0 +1,160 @@
+#include "ParticleSystem.h"
+#include "GameConstants.h"
+#include "WorldSnapshot.h"
+#include <vector>
+#include <cmath>
+using namespace std;
+
+// the flash is the old Explosion actor: full size, then 1.5x bigger each tick for three ticks
+const float FLASH_GROWTH = 1.5f;
+const int	FLASH_TICKS = 4;
+
+ParticleSystem::ParticleSystem()
+	: m_dropped(0)
+{
+	clear();
+}
+
+void ParticleSystem::spawnExplosion(double x, double y, Rng& rng)
+{
+	static const float PI = 4 * atan(1.0f);
+	float fx = static_cast<float>(x), fy = static_cast<float>(y);
+	for (int i = 0; i < DEBRIS_PER_EXPLOSION; ++i)	// shards flying off in every direction, shrinking as they go
+	{
+		float angle = rng.nextInt(0, 359) * PI / 180;
+		float speed = rng.nextInt(10, 40) / 10.0f;
+		float size = rng.nextInt(20, 50) / 100.0f;
+		int ticks = rng.nextInt(6, 14);
+		emit(PARTICLE_DEBRIS, fx, fy, speed * cos(angle), speed * sin(angle), size, .9f, ticks);
+	}
+	emit(PARTICLE_FLASH, fx, fy, 0, 0, 1, FLASH_GROWTH, FLASH_TICKS);
+}
+
+void ParticleSystem::update()
+{
+	for (int type = 0; type < NUM_PARTICLE_TYPES; ++type)
+	{
+		Particles& p = m_particles[type];
+		unsigned int n = p.count;
+
+		// straight-line arithmetic over plain arrays, so the compiler vectorizes it
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			p.x[i] += p.vx[i];
+			p.y[i] += p.vy[i];
+			p.size[i] *= p.growth[i];
+			p.ticksLeft[i]--;
+		}
+
+		// slide the survivors down over the expired ones, keeping their order
+		unsigned int nKept = 0;
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			if (p.ticksLeft[i] <= 0)
+				continue;
+			p.x[nKept] = p.x[i];
+			p.y[nKept] = p.y[i];
+			p.vx[nKept] = p.vx[i];
+			p.vy[nKept] = p.vy[i];
+			p.size[nKept] = p.size[i];
+			p.growth[nKept] = p.growth[i];
+			p.ticksLeft[nKept] = p.ticksLeft[i];
+			nKept++;
+		}
+		p.count = nKept;
+	}
+}
+
+void ParticleSystem::clear()
+{
+	for (int type = 0; type < NUM_PARTICLE_TYPES; ++type)
+		m_particles[type].count = 0;
+}
+
+unsigned int ParticleSystem::size() const
+{
+	unsigned int n = 0;
+	for (int type = 0; type < NUM_PARTICLE_TYPES; ++type)
+		n += m_particles[type].count;
+	return n;
+}
+
+unsigned long long ParticleSystem::getDropped() const
+{
+	return m_dropped;
+}
+
+void ParticleSystem::getBatches(vector<SpriteBatch>& batches) const
+{
+	static const int IMAGE[NUM_PARTICLE_TYPES] = { IID_STAR, IID_EXPLOSION };
+	for (int type = 0; type < NUM_PARTICLE_TYPES; ++type)
+	{
+		const Particles& p = m_particles[type];
+		if (p.count == 0)
+			continue;
+		SpriteBatch batch;
+		batch.imageID = IMAGE[type];
+		batch.x = p.x;
+		batch.y = p.y;
+		batch.size = p.size;
+		batch.count = p.count;
+		batch.dxPerTick = 0;
+		batch.dx = p.vx;
+		batch.dy = p.vy;
+		batches.push_back(batch);
+	}
+}
+
+void ParticleSystem::save(SnapshotWriter& out) const
+{
+	for (int type = 0; type < NUM_PARTICLE_TYPES; ++type)
+	{
+		const Particles& p = m_particles[type];
+		out.writeArray(p.x, p.count);
+		out.writeArray(p.y, p.count);
+		out.writeArray(p.vx, p.count);
+		out.writeArray(p.vy, p.count);
+		out.writeArray(p.size, p.count);
+		out.writeArray(p.growth, p.count);
+		out.writeArray(p.ticksLeft, p.count);
+	}
+}
+
+void ParticleSystem::load(SnapshotReader& in)
+{
+	for (int type = 0; type < NUM_PARTICLE_TYPES; ++type)
+	{
+		Particles& p = m_particles[type];
+		p.count = in.readArray(p.x, MAX_PARTICLES_PER_TYPE);
+		bool sameCounts = in.readArray(p.y, MAX_PARTICLES_PER_TYPE) == p.count;
+		sameCounts &= in.readArray(p.vx, MAX_PARTICLES_PER_TYPE) == p.count;
+		sameCounts &= in.readArray(p.vy, MAX_PARTICLES_PER_TYPE) == p.count;
+		sameCounts &= in.readArray(p.size, MAX_PARTICLES_PER_TYPE) == p.count;
+		sameCounts &= in.readArray(p.growth, MAX_PARTICLES_PER_TYPE) == p.count;
+		sameCounts &= in.readArray(p.ticksLeft, MAX_PARTICLES_PER_TYPE) == p.count;
+		if (!sameCounts || in.failed())
+		{
+			in.fail();
+			clear();
+			return;
+		}
+	}
+}
+
+void ParticleSystem::emit(ParticleType type, float x, float y, float vx, float vy, float size, float growth, int ticks)
+{
+	Particles& p = m_particles[type];
+	if (p.count == MAX_PARTICLES_PER_TYPE)
+	{
+		m_dropped++;
+		return;
+	}
+	unsigned int i = p.count++;
+	p.x[i] = x;
+	p.y[i] = y;
+	p.vx[i] = vx;
+	p.vy[i] = vy;
+	p.size[i] = size;
+	p.growth[i] = growth;
+	p.ticksLeft[i] = ticks;
+}
@@ -0,0 +1,62 @@
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+
+#include "GameWorld.h"
+#include "Random.h"
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+  // Short-lived effects that nothing can collide with. Each type of particle has
+  // its own fixed-size set of parallel arrays, so spawning never allocates, one
+  // loop updates a whole type per tick, and each type draws as one SpriteBatch.
+  // When a type is full, new particles of that type are dropped.
+
+enum ParticleType
+{
+	PARTICLE_DEBRIS,	// drawn first, so the flash covers it
+	PARTICLE_FLASH,
+	NUM_PARTICLE_TYPES
+};
+
+class ParticleSystem
+{
+public:
+	static const unsigned int MAX_PARTICLES_PER_TYPE = 512;
+	static const int DEBRIS_PER_EXPLOSION = 12;
+
+	ParticleSystem();
+	void spawnExplosion(double x, double y, Rng& rng);	// a growing flash plus a spray of debris
+	void update();	// moves, grows and ages every particle, then drops the expired ones
+	void clear();
+	unsigned int size() const;	// live particles of every type
+	unsigned long long getDropped() const;	// particles that didn't fit since construction
+	void getBatches(std::vector<SpriteBatch>& batches) const;	// one per type
+	void save(SnapshotWriter& out) const;
+	void load(SnapshotReader& in);
+
+private:
+	struct Particles
+	{
+		float x[MAX_PARTICLES_PER_TYPE];
+		float y[MAX_PARTICLES_PER_TYPE];
+		float vx[MAX_PARTICLES_PER_TYPE];	// pixels per tick
+		float vy[MAX_PARTICLES_PER_TYPE];
+		float size[MAX_PARTICLES_PER_TYPE];
+		float growth[MAX_PARTICLES_PER_TYPE];	// size multiplier per tick
+		int   ticksLeft[MAX_PARTICLES_PER_TYPE];
+		unsigned int count;
+	};
+
+	void emit(ParticleType type, float x, float y, float vx, float vy, float size, float growth, int ticks);
+
+	Particles m_particles[NUM_PARTICLE_TYPES];
+	unsigned long long m_dropped;
+
+	// Prevent copying or assigning ParticleSystems
+	ParticleSystem(const ParticleSystem&) = delete;
+	ParticleSystem& operator=(const ParticleSystem&) = delete;
+};
+
+#endif // PARTICLESYSTEM_H_
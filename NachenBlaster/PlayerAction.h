@@ -0,0 +1,60 @@
+#ifndef PLAYERACTION_H_
+#define PLAYERACTION_H_
+
+#include "GameConstants.h"
+#include <cstdint>
+
+  // Everything the player does in one tick: move up to one step on each axis,
+  // fire a cabbage, fire a torpedo, or any of those at once. A keyboard can only
+  // press one key a tick, so its actions only ever have one of them set.
+
+struct PlayerAction
+{
+	signed char	dx;			// -1 left, 0, 1 right
+	signed char	dy;			// -1 down, 0, 1 up
+	bool		fire;		// a cabbage, if there's the energy
+	bool		torpedo;	// a torpedo, if there's one left
+	bool		quit;		// end the game (never recorded: a replay ends where its recording did)
+
+	  // Bits of the packed form (also the NBAction bits of VecEnv.h)
+	enum
+	{
+		UP = 1, DOWN = 2, LEFT = 4, RIGHT = 8, FIRE = 16, TORPEDO = 32,
+		ALL = 63
+	};
+
+	std::uint32_t pack() const
+	{
+		return (dy > 0 ? UP : 0) | (dy < 0 ? DOWN : 0) | (dx < 0 ? LEFT : 0) | (dx > 0 ? RIGHT : 0) |
+			   (fire ? FIRE : 0) | (torpedo ? TORPEDO : 0);
+	}
+
+	static PlayerAction unpack(std::uint32_t bits)	// up and down together cancel out, as do left and right
+	{
+		PlayerAction action;
+		action.dx = static_cast<signed char>(((bits & RIGHT) != 0) - ((bits & LEFT) != 0));
+		action.dy = static_cast<signed char>(((bits & UP) != 0) - ((bits & DOWN) != 0));
+		action.fire = (bits & FIRE) != 0;
+		action.torpedo = (bits & TORPEDO) != 0;
+		action.quit = false;
+		return action;
+	}
+
+	static PlayerAction fromKey(int key)	// what pressing key does, as the keyboard always has
+	{
+		PlayerAction action = unpack(0);
+		switch (key)
+		{
+		case KEY_PRESS_UP:		action.dy = 1;			break;
+		case KEY_PRESS_DOWN:	action.dy = -1;			break;
+		case KEY_PRESS_LEFT:	action.dx = -1;			break;
+		case KEY_PRESS_RIGHT:	action.dx = 1;			break;
+		case KEY_PRESS_SPACE:	action.fire = true;		break;
+		case KEY_PRESS_TAB:		action.torpedo = true;	break;
+		case 'q': case '\x03':	action.quit = true;		break;	// CTRL-C
+		}
+		return action;
+	}
+};
+
+#endif // PLAYERACTION_H_
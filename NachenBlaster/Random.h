@@ -0,0 +1,91 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+  // Small, fast random number generator (PCG32: 64 bits of state, 32 bit output).
+  // Two generators with the same seed and stream produce the same numbers, and
+  // different streams from one seed are independent, so a world can hand out
+  // separate sub-streams for spawning, AI and cosmetics without them disturbing each other.
+
+class Rng
+{
+public:
+	Rng(std::uint64_t seed = 0, std::uint64_t stream = 0)
+	{
+		this->seed(seed, stream);
+	}
+
+	void seed(std::uint64_t seed, std::uint64_t stream)
+	{
+		m_state = 0;
+		m_inc = (stream << 1) | 1;
+		next();
+		m_state += seed;
+		next();
+	}
+
+	std::uint32_t next()
+	{
+		std::uint64_t old = m_state;
+		m_state = old * 6364136223846793005ULL + m_inc;
+		std::uint32_t xorShifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+		std::uint32_t rot = static_cast<std::uint32_t>(old >> 59);
+		return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+	}
+
+	  // Return a uniformly distributed random int from min to max, inclusive
+	int nextInt(int min, int max)
+	{
+		if (max < min)
+		{
+			int temp = min;
+			min = max;
+			max = temp;
+		}
+		std::uint32_t range = static_cast<std::uint32_t>(max - min) + 1;
+		if (range == 0)	// the full 32 bit range
+			return static_cast<int>(next());
+		  // multiply-and-shift instead of %, rejecting the few values that would bias the result
+		std::uint64_t product = static_cast<std::uint64_t>(next()) * range;
+		std::uint32_t low = static_cast<std::uint32_t>(product);
+		if (low < range)
+		{
+			std::uint32_t threshold = (0u - range) % range;
+			while (low < threshold)
+			{
+				product = static_cast<std::uint64_t>(next()) * range;
+				low = static_cast<std::uint32_t>(product);
+			}
+		}
+		return min + static_cast<int>(product >> 32);
+	}
+
+	  // raw state, for saving and restoring a generator exactly
+	std::uint64_t getState() const
+	{
+		return m_state;
+	}
+
+	std::uint64_t getIncrement() const
+	{
+		return m_inc;
+	}
+
+	void setState(std::uint64_t state, std::uint64_t increment)
+	{
+		m_state = state;
+		m_inc = increment | 1;
+	}
+
+private:
+	std::uint64_t m_state;
+	std::uint64_t m_inc;
+};
+
+  // sub-streams a StudentWorld draws from
+const std::uint64_t RNG_STREAM_SPAWN	= 1;
+const std::uint64_t RNG_STREAM_AI		= 2;
+const std::uint64_t RNG_STREAM_COSMETIC	= 3;
+
+#endif // RANDOM_H_
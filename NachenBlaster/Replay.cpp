@@ -0,0 +1,158 @@
+#include "Replay.h"
+#include "WorldSnapshot.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// more than this in a file means it's corrupt (an action every tick for a couple of days of play)
+const uint32_t MAX_REPLAY_ACTIONS = 1 << 24;
+const uint32_t MAX_REPLAY_KEYFRAMES = MAX_REPLAY_ACTIONS / REPLAY_KEYFRAME_INTERVAL;
+
+Replay::Replay()
+{
+	start(0);
+}
+
+void Replay::start(uint64_t seed)
+{
+	m_seed = seed;
+	m_ticks = 0;
+	m_score = 0;
+	m_level = 0;
+	m_lives = 0;
+	m_actions.clear();
+	m_keyframes.clear();
+	m_nextAction = 0;
+}
+
+void Replay::addAction(unsigned long tick, const PlayerAction& action)
+{
+	ReplayAction a = { static_cast<uint32_t>(tick), action.pack() };
+	m_actions.push_back(a);
+}
+
+WorldSnapshot& Replay::addKeyframe(unsigned long tick)
+{
+	m_keyframes.emplace_back();
+	ReplayKeyframe& keyframe = m_keyframes.back();
+	keyframe.tick = static_cast<uint32_t>(tick);
+	keyframe.firstAction = static_cast<uint32_t>(m_actions.size());
+	return keyframe.snapshot;
+}
+
+void Replay::setEnd(unsigned long ticks, unsigned int score, unsigned int level, unsigned int lives)
+{
+	m_ticks = static_cast<uint32_t>(ticks);
+	m_score = score;
+	m_level = level;
+	m_lives = lives;
+}
+
+bool Replay::nextAction(unsigned long tick, PlayerAction& action)
+{
+	if (tick >= m_ticks)	// the player quit here (or the recording was cut short)
+	{
+		action = PlayerAction::unpack(0);
+		action.quit = true;
+		return true;
+	}
+	while (m_nextAction < m_actions.size() && m_actions[m_nextAction].tick < tick)	// not asked for on its tick: skip it
+		m_nextAction++;
+	if (m_nextAction == m_actions.size() || m_actions[m_nextAction].tick != tick)
+		return false;
+	action = PlayerAction::unpack(m_actions[m_nextAction++].action);
+	return true;
+}
+
+const ReplayKeyframe* Replay::findKeyframe(unsigned long tick) const
+{
+	vector<ReplayKeyframe>::const_iterator p = upper_bound(m_keyframes.begin(), m_keyframes.end(), tick,
+		[](unsigned long t, const ReplayKeyframe& keyframe) { return t < keyframe.tick; });
+	if (p == m_keyframes.begin())
+		return nullptr;
+	return &*(p - 1);
+}
+
+void Replay::rewindTo(unsigned long tick)
+{
+	vector<ReplayAction>::const_iterator p = lower_bound(m_actions.begin(), m_actions.end(), tick,
+		[](const ReplayAction& a, unsigned long t) { return a.tick < t; });
+	m_nextAction = p - m_actions.begin();
+}
+
+bool Replay::save(const string& path) const
+{
+	WorldSnapshot file;	// just a byte buffer that knows how to write itself out
+	SnapshotWriter w(file.bytes);
+	w.write(REPLAY_MAGIC);
+	w.write(REPLAY_VERSION);
+	w.write(m_seed);
+	w.write(m_ticks);
+	w.write(m_score);
+	w.write(m_level);
+	w.write(m_lives);
+	w.writeArray(m_actions.data(), m_actions.size());
+	w.write(static_cast<uint32_t>(m_keyframes.size()));
+
+	// the index entries are a fixed size, so the snapshots' offsets are known before they're written
+	const size_t INDEX_ENTRY_SIZE = 2 * sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+	uint64_t offset = file.bytes.size() + m_keyframes.size() * INDEX_ENTRY_SIZE;
+	for (const ReplayKeyframe& keyframe : m_keyframes)
+	{
+		w.write(keyframe.tick);
+		w.write(keyframe.firstAction);
+		w.write(offset);
+		w.write(static_cast<uint32_t>(keyframe.snapshot.bytes.size()));
+		offset += keyframe.snapshot.bytes.size();
+	}
+	for (const ReplayKeyframe& keyframe : m_keyframes)
+		file.bytes.insert(file.bytes.end(), keyframe.snapshot.bytes.begin(), keyframe.snapshot.bytes.end());
+	return file.writeFile(path);
+}
+
+bool Replay::load(const string& path)
+{
+	start(0);
+	WorldSnapshot file;
+	if (!file.readFile(path))
+		return false;
+	SnapshotReader r(file.bytes.data(), file.bytes.size());
+	if (r.read<uint32_t>() != REPLAY_MAGIC || r.read<uint32_t>() != REPLAY_VERSION)
+		return false;
+	r.read(m_seed);
+	r.read(m_ticks);
+	r.read(m_score);
+	r.read(m_level);
+	r.read(m_lives);
+	r.readArray(m_actions, MAX_REPLAY_ACTIONS);
+	if (!is_sorted(m_actions.begin(), m_actions.end(), [](const ReplayAction& a, const ReplayAction& b) { return a.tick < b.tick; }))
+		r.fail();
+	for (const ReplayAction& a : m_actions)
+		if (a.action > PlayerAction::ALL)
+			r.fail();
+	uint32_t nKeyframes = r.read<uint32_t>();
+	if (nKeyframes > MAX_REPLAY_KEYFRAMES)
+		r.fail();
+	for (uint32_t i = 0; i < nKeyframes && !r.failed(); i++)
+	{
+		m_keyframes.emplace_back();
+		ReplayKeyframe& keyframe = m_keyframes.back();
+		r.read(keyframe.tick);
+		r.read(keyframe.firstAction);
+		uint64_t offset = r.read<uint64_t>();
+		uint32_t size = r.read<uint32_t>();
+		if (offset > file.bytes.size() || size > file.bytes.size() - offset || keyframe.firstAction > m_actions.size() ||
+			(i > 0 && keyframe.tick <= m_keyframes[i - 1].tick))
+			r.fail();
+		else
+			keyframe.snapshot.bytes.assign(file.bytes.begin() + offset, file.bytes.begin() + offset + size);
+	}
+	if (r.failed())
+	{
+		start(0);
+		return false;
+	}
+	return true;
+}
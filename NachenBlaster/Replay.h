@@ -0,0 +1,103 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "WorldSnapshot.h"
+#include "PlayerAction.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+  // A recorded game: the world seed plus every action StudentWorld::getAction handed
+  // the user (packed, see PlayerAction::pack), tagged with the tick it was read on.
+  // Ticks the user did nothing on aren't kept. Since the world only ever asks for
+  // actions at the same ticks when it's given the same seed and the same actions,
+  // playing them back reproduces the game exactly, whatever input source made them.
+  //
+  // Every REPLAY_KEYFRAME_INTERVAL ticks the recording also keeps a WorldSnapshot,
+  // so playback can start from the nearest keyframe instead of tick 0. The file is
+  //     header, actions, keyframe index (tick, first action, offset, size), keyframe snapshots
+  // with the index ahead of the snapshots, so it can be read without reading them.
+
+const std::uint32_t REPLAY_MAGIC = 0x5052424e;	// "NBRP"
+const std::uint32_t REPLAY_VERSION = 2;	// 1 recorded keys rather than actions
+const unsigned long REPLAY_KEYFRAME_INTERVAL = 256;	// ticks between keyframes
+
+struct ReplayAction
+{
+	std::uint32_t	tick;	// world tick (StudentWorld::getTick) the action was read on
+	std::uint32_t	action;	// PlayerAction::pack
+};
+
+struct ReplayKeyframe
+{
+	std::uint32_t	tick;		// the world just before this tick
+	std::uint32_t	firstAction;	// index of the first action read on or after it
+	WorldSnapshot	snapshot;
+};
+
+class Replay
+{
+public:
+	Replay();
+
+	  // Recording (StudentWorld::setRecording does this)
+	void start(std::uint64_t seed);	// forgets everything recorded so far
+	void addAction(unsigned long tick, const PlayerAction& action);
+	WorldSnapshot& addKeyframe(unsigned long tick);	// save the world into the snapshot returned
+	void setEnd(unsigned long ticks, unsigned int score, unsigned int level, unsigned int lives);
+
+	  // Playback (StudentWorld::setPlayback does this)
+	bool nextAction(unsigned long tick, PlayerAction& action);	// the action recorded on tick, if any; quit once the recording is over
+	const ReplayKeyframe* findKeyframe(unsigned long tick) const;	// the last one at or before tick, or nullptr
+	void rewindTo(unsigned long tick);	// nextAction carries on from the first action read on or after tick
+
+	bool save(const std::string& path) const;	// false if the file couldn't be written
+	bool load(const std::string& path);	// false if it couldn't be read or isn't a replay of this version
+
+	std::uint64_t getSeed() const
+	{
+		return m_seed;
+	}
+
+	unsigned long getTicks() const	// how long the recorded game went on for
+	{
+		return m_ticks;
+	}
+
+	unsigned int getScore() const	// score, level and lives when it ended
+	{
+		return m_score;
+	}
+
+	unsigned int getLevel() const
+	{
+		return m_level;
+	}
+
+	unsigned int getLives() const
+	{
+		return m_lives;
+	}
+
+	std::size_t getActionCount() const
+	{
+		return m_actions.size();
+	}
+
+	std::size_t getKeyframeCount() const
+	{
+		return m_keyframes.size();
+	}
+
+private:
+	std::uint64_t				m_seed;
+	std::uint32_t				m_ticks;
+	std::uint32_t				m_score;
+	std::uint32_t				m_level;
+	std::uint32_t				m_lives;
+	std::vector<ReplayAction>	m_actions;	// in the order they were read
+	std::vector<ReplayKeyframe>	m_keyframes;	// in tick order
+	std::size_t					m_nextAction;	// playback position in m_actions
+};
+
+#endif // REPLAY_H_
@@ -0,0 +1,253 @@
+#include "RewindBuffer.h"
+#include "WorldSnapshot.h"
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+// differing words closer together than this share a run, since each run costs 8 bytes of header
+const size_t RUN_MERGE_GAP = 1;
+// more than this in a delta means it's corrupt
+const uint32_t MAX_FRAME_SLOTS = 1 << 16;
+const uint32_t MAX_ACTOR_STATE_BYTES = 1 << 12;
+const uint32_t MAX_FRAME_PART_BYTES = 1 << 24;
+
+// to as (size, run count, runs of (offset, bytes)) against from
+static void encodeBytes(const vector<unsigned char>& from, const vector<unsigned char>& to, vector<unsigned char>& out)
+{
+	SnapshotWriter w(out);
+	w.write(static_cast<uint32_t>(to.size()));
+	size_t countAt = out.size();
+	uint32_t nRuns = 0;
+	w.write(nRuns);
+	auto writeRun = [&](size_t start, size_t end)
+	{
+		w.write(static_cast<uint32_t>(start));
+		w.writeArray(to.data() + start, static_cast<uint32_t>(end - start));
+		nRuns++;
+	};
+
+	// compared a word at a time: runs start and end on word boundaries
+	size_t common = min(from.size(), to.size());
+	auto differs = [&](size_t word)
+	{
+		size_t at = word * sizeof(uint64_t);
+		if (at + sizeof(uint64_t) > common)
+			return memcmp(from.data() + at, to.data() + at, common - at) != 0;
+		uint64_t a, b;
+		memcpy(&a, from.data() + at, sizeof(a));
+		memcpy(&b, to.data() + at, sizeof(b));
+		return a != b;
+	};
+	size_t nWords = (common + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	size_t i = 0;
+	while (i < nWords)
+	{
+		if (!differs(i))
+		{
+			i++;
+			continue;
+		}
+		size_t start = i;
+		size_t end = i + 1;	// just past the last word that differs
+		for (i = end; i < nWords && i - end < RUN_MERGE_GAP; i++)
+			if (differs(i))
+				end = i + 1;
+		writeRun(start * sizeof(uint64_t), min(end * sizeof(uint64_t), common));
+		i = end;
+	}
+	if (to.size() > common)
+		writeRun(common, to.size());
+	memcpy(&out[countAt], &nRuns, sizeof(nRuns));
+}
+
+static void decodeBytes(SnapshotReader& in, vector<unsigned char>& bytes)
+{
+	uint32_t size = in.read<uint32_t>();
+	if (size > MAX_FRAME_PART_BYTES)
+	{
+		in.fail();
+		return;
+	}
+	bytes.resize(size);
+	uint32_t nRuns = in.read<uint32_t>();
+	for (uint32_t i = 0; i < nRuns && !in.failed(); i++)
+	{
+		uint32_t start = in.read<uint32_t>();
+		if (start > size)
+			in.fail();
+		else
+			in.readArray(bytes.data() + start, size - start);
+	}
+}
+
+RewindBuffer::RewindBuffer(size_t maxBytes)
+	: m_maxBytes(maxBytes), m_bytes(0), m_restart(true)
+{
+}
+
+void RewindBuffer::setBudget(size_t maxBytes)
+{
+	m_maxBytes = maxBytes;
+	if (m_maxBytes == 0)
+		clear();
+	while (m_bytes > m_maxBytes && m_groups.size() > 1)
+		dropOldest();
+}
+
+void RewindBuffer::clear()
+{
+	while (!m_groups.empty())
+		dropOldest();
+	m_bytes = 0;
+	m_restart = true;
+}
+
+WorldFrame& RewindBuffer::nextFrame()
+{
+	return m_next;
+}
+
+void RewindBuffer::commit(unsigned long tick)
+{
+	if (m_maxBytes == 0)
+		return;
+	if (!m_groups.empty() && tick != getNewestTick() + 1)	// a jump: what we have is from another timeline
+		clear();
+	if (m_restart || m_groups.back().deltaEnds.size() + 1 >= REWIND_KEYFRAME_INTERVAL)
+		startGroup(tick);
+	else
+	{
+		Group& group = m_groups.back();
+		size_t before = group.deltas.size();
+		encodeDelta(m_last, m_next, group.deltas);
+		group.deltaEnds.push_back(static_cast<uint32_t>(group.deltas.size()));
+		group.bytes += group.deltas.size() - before + sizeof(uint32_t);
+		m_bytes += group.deltas.size() - before + sizeof(uint32_t);
+	}
+	swap(m_last, m_next);
+	while (m_bytes > m_maxBytes && m_groups.size() > 1)
+		dropOldest();
+}
+
+bool RewindBuffer::reconstruct(unsigned long tick, WorldFrame& out) const
+{
+	if (m_groups.empty() || tick < getOldestTick() || tick > getNewestTick())
+		return false;
+	deque<Group>::const_iterator p = upper_bound(m_groups.begin(), m_groups.end(), tick,
+		[](unsigned long t, const Group& group) { return t < group.firstTick; }) - 1;
+	out = p->keyframe;
+	uint32_t start = 0;
+	for (unsigned long i = 0; i < tick - p->firstTick; i++)
+	{
+		if (!applyDelta(p->deltas.data() + start, p->deltaEnds[i] - start, out))
+			return false;
+		start = p->deltaEnds[i];
+	}
+	return true;
+}
+
+void RewindBuffer::discardFrom(unsigned long tick)
+{
+	while (!m_groups.empty() && m_groups.back().firstTick >= tick)
+	{
+		m_bytes -= m_groups.back().bytes;
+		if (m_spare.empty())
+			m_spare.push_back(move(m_groups.back()));
+		m_groups.pop_back();
+	}
+	if (!m_groups.empty() && getNewestTick() >= tick)
+	{
+		Group& group = m_groups.back();
+		size_t keep = tick - group.firstTick - 1;	// deltas for the ticks after the keyframe and before tick
+		size_t before = group.deltas.size() + group.deltaEnds.size() * sizeof(uint32_t);
+		group.deltas.resize(keep > 0 ? group.deltaEnds[keep - 1] : 0);
+		group.deltaEnds.resize(keep);
+		size_t freed = before - group.deltas.size() - group.deltaEnds.size() * sizeof(uint32_t);
+		group.bytes -= freed;
+		m_bytes -= freed;
+	}
+	m_restart = true;	// m_last isn't the newest frame any more
+}
+
+void RewindBuffer::startGroup(unsigned long tick)
+{
+	if (m_spare.empty())
+		m_groups.emplace_back();
+	else
+	{
+		m_groups.push_back(move(m_spare.back()));
+		m_spare.pop_back();
+	}
+	Group& group = m_groups.back();
+	group.firstTick = tick;
+	group.keyframe = m_next;	// reuses the buffers of a spare group
+	group.deltas.clear();
+	group.deltaEnds.clear();
+	group.bytes = frameBytes(group.keyframe);
+	m_bytes += group.bytes;
+	m_restart = false;
+}
+
+void RewindBuffer::dropOldest()
+{
+	m_bytes -= m_groups.front().bytes;
+	if (m_spare.empty())	// one is enough to recycle
+		m_spare.push_back(move(m_groups.front()));
+	m_groups.pop_front();
+}
+
+size_t RewindBuffer::frameBytes(const WorldFrame& frame)
+{
+	size_t bytes = frame.globals.size() + frame.effects.size();
+	for (const vector<unsigned char>& state : frame.actors)
+		bytes += state.size();
+	return bytes;
+}
+
+// globals and effects as runs of changed bytes, then the slot count and each slot whose state changed
+void RewindBuffer::encodeDelta(const WorldFrame& from, const WorldFrame& to, vector<unsigned char>& out)
+{
+	encodeBytes(from.globals, to.globals, out);
+	encodeBytes(from.effects, to.effects, out);
+	SnapshotWriter w(out);
+	w.write(static_cast<uint32_t>(to.actors.size()));
+	size_t countAt = out.size();
+	uint32_t nChanged = 0;
+	w.write(nChanged);
+	static const vector<unsigned char> NO_STATE;
+	for (size_t slot = 0; slot < to.actors.size(); slot++)
+	{
+		const vector<unsigned char>& before = (slot < from.actors.size() ? from.actors[slot] : NO_STATE);
+		const vector<unsigned char>& after = to.actors[slot];
+		if (before == after)
+			continue;
+		w.write(static_cast<uint32_t>(slot));
+		w.writeArray(after.data(), static_cast<uint32_t>(after.size()));
+		nChanged++;
+	}
+	memcpy(&out[countAt], &nChanged, sizeof(nChanged));
+}
+
+bool RewindBuffer::applyDelta(const unsigned char* data, size_t size, WorldFrame& frame)
+{
+	SnapshotReader r(data, size);
+	decodeBytes(r, frame.globals);
+	decodeBytes(r, frame.effects);
+	uint32_t nSlots = r.read<uint32_t>();
+	if (nSlots > MAX_FRAME_SLOTS)
+		return false;
+	frame.actors.resize(nSlots);
+	uint32_t nChanged = r.read<uint32_t>();
+	for (uint32_t i = 0; i < nChanged && !r.failed(); i++)
+	{
+		uint32_t slot = r.read<uint32_t>();
+		if (slot >= nSlots)
+			return false;
+		r.readArray(frame.actors[slot], MAX_ACTOR_STATE_BYTES);
+	}
+	return !r.failed() && r.atEnd();
+}
@@ -0,0 +1,100 @@
+#ifndef REWINDBUFFER_H_
+#define REWINDBUFFER_H_
+
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+  // A StudentWorld between two ticks (see StudentWorld::saveFrame), split up so that
+  // each actor's state stands on its own under its actor table slot. That way a
+  // tick's delta only has to hold the actors that actually changed.
+
+struct WorldFrame
+{
+	std::vector<unsigned char> globals;	// lives/score/level, counters, the actor table, which slots hold which kinds, random streams
+	std::vector<unsigned char> effects;	// starfield and particles
+	std::vector<std::vector<unsigned char>> actors;	// Actor::saveState of the actor in each slot; empty if the slot is free
+};
+
+const std::size_t DEFAULT_REWIND_BYTES = 8 << 20;
+const unsigned int REWIND_KEYFRAME_INTERVAL = 64;	// ticks per keyframe; rewinding applies at most this many deltas
+
+  // The last stretch of a game, one frame per tick, in as much memory as the budget
+  // allows. Every REWIND_KEYFRAME_INTERVAL ticks a whole frame is kept; the ticks in
+  // between keep only what changed since the tick before: the actors whose state
+  // bytes differ, and the runs of bytes that differ in the globals and effects.
+  // When the budget is exceeded the oldest keyframe and its deltas go.
+  //
+  //     saveFrame(rewind.nextFrame());	// at the start of every tick
+  //     rewind.commit(tick);
+  //     ...
+  //     rewind.reconstruct(earlierTick, frame);	// then load the frame
+
+class RewindBuffer
+{
+public:
+	explicit RewindBuffer(std::size_t maxBytes = DEFAULT_REWIND_BYTES);
+
+	void setBudget(std::size_t maxBytes);	// 0 turns it off
+	void clear();
+
+	  // Save the world into nextFrame(), then commit it as the world just before tick.
+	  // A tick that doesn't follow on from the last one starts the buffer afresh.
+	WorldFrame& nextFrame();
+	void commit(unsigned long tick);
+
+	bool reconstruct(unsigned long tick, WorldFrame& out) const;	// false if tick isn't in the buffer
+	void discardFrom(unsigned long tick);	// forget tick and everything after it, e.g. after rewinding to it
+
+	bool isEnabled() const
+	{
+		return m_maxBytes > 0;
+	}
+
+	bool empty() const
+	{
+		return m_groups.empty();
+	}
+
+	unsigned long getOldestTick() const	// the buffer holds [oldest, newest]; meaningless if empty()
+	{
+		return m_groups.front().firstTick;
+	}
+
+	unsigned long getNewestTick() const
+	{
+		return m_groups.back().firstTick + m_groups.back().deltaEnds.size();
+	}
+
+	std::size_t getBytes() const	// memory the frames take up
+	{
+		return m_bytes;
+	}
+
+private:
+	struct Group	// a keyframe and the deltas for the ticks after it
+	{
+		unsigned long				firstTick;	// the keyframe's
+		WorldFrame					keyframe;
+		std::vector<unsigned char>	deltas;	// one after another
+		std::vector<std::uint32_t>	deltaEnds;	// where each one ends in deltas
+		std::size_t					bytes;
+	};
+
+	std::size_t			m_maxBytes;
+	std::size_t			m_bytes;
+	std::deque<Group>	m_groups;
+	std::vector<Group>	m_spare;	// dropped groups, kept for their buffers
+	WorldFrame			m_next;
+	WorldFrame			m_last;	// the newest frame, which the next delta is taken against
+	bool				m_restart;	// the next commit starts a new keyframe
+
+	void startGroup(unsigned long tick);
+	void dropOldest();
+	static std::size_t frameBytes(const WorldFrame& frame);
+	static void encodeDelta(const WorldFrame& from, const WorldFrame& to, std::vector<unsigned char>& out);
+	static bool applyDelta(const unsigned char* data, std::size_t size, WorldFrame& frame);
+};
+
+#endif // REWINDBUFFER_H_
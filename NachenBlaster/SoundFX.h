@@ -3,6 +3,8 @@
 
 #include <string>
 
+  // Plays the game's sound clips. The GameController owns one; nothing else makes sound.
+
 #if defined(_MSC_VER)
 
 #include "irrKlang/irrKlang.h"
@@ -25,11 +27,6 @@ class SoundFXController
 			m_engine->stopAllSounds();
 	}
 
-	static SoundFXController& getInstance();
-
-  private:
-	irrklang::ISoundEngine* m_engine;
-
 	SoundFXController()
 	{
 		m_engine = irrklang::createIrrKlangDevice();
@@ -44,8 +41,11 @@ class SoundFXController
 			m_engine->drop();
 	}
 
-	SoundFXController(const SoundFXController&);
-	SoundFXController& operator=(const SoundFXController&);
+  private:
+	irrklang::ISoundEngine* m_engine;
+
+	SoundFXController(const SoundFXController&) = delete;
+	SoundFXController& operator=(const SoundFXController&) = delete;
 };
 
 #elif defined(__APPLE__)
@@ -68,7 +68,6 @@ class SoundFXController
 	void playClip(std::string soundFile)
 	{
 		  // Don't start a clip more than 2 times per second
-		static std::chrono::system_clock::time_point lastPlayTime;
 		auto now = std::chrono::system_clock::now();
 		if (now - lastPlayTime < std::chrono::milliseconds(500))
 			return;
@@ -90,11 +89,10 @@ class SoundFXController
 		pidValid = false;
 	}
 	
-	static SoundFXController& getInstance();
-
   private:
 	pid_t pid;
 	bool pidValid;
+	std::chrono::system_clock::time_point lastPlayTime;
 };
 
 #else  // forget about sound
@@ -104,21 +102,8 @@ class SoundFXController
   public:
 	void playClip(std::string) {}
 	void abortClip() {}
-	static SoundFXController& getInstance();
 };
 
 #endif
 
-  // Meyers singleton pattern
-inline SoundFXController& SoundFXController::getInstance()
-{
-	static SoundFXController instance;
-	return instance;
-}
-
-inline SoundFXController& SoundFX()
-{
-	return SoundFXController::getInstance();
-}
-
 #endif // SOUNDFX_H_
@@ -0,0 +1,79 @@
+#include "SpatialGrid.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+SpatialGrid::SpatialGrid()
+	: m_cellStart(GRID_COLS * GRID_ROWS + 1, 0), m_maxRadius(0)
+{
+}
+
+void SpatialGrid::clear()
+{
+	m_pending.clear();
+	m_maxRadius = 0;
+}
+
+void SpatialGrid::add(int index, double x, double y, double radius)
+{
+	Entry e;
+	e.index = index;
+	e.cell = rowOf(y) * GRID_COLS + colOf(x);
+	m_pending.push_back(e);
+	if (radius > m_maxRadius)
+		m_maxRadius = radius;
+}
+
+// counting sort of the pending entries by cell (stable, so each cell keeps the order things were added in)
+void SpatialGrid::build()
+{
+	fill(m_cellStart.begin(), m_cellStart.end(), 0);
+	for (const Entry& e : m_pending)
+		m_cellStart[e.cell + 1]++;
+	for (unsigned int c = 1; c < m_cellStart.size(); ++c)
+		m_cellStart[c] += m_cellStart[c - 1];
+
+	m_sorted.resize(m_pending.size());
+	vector<int>::size_type nCells = m_cellStart.size() - 1;
+	int next[GRID_COLS * GRID_ROWS];
+	for (vector<int>::size_type c = 0; c < nCells; ++c)
+		next[c] = m_cellStart[c];
+	for (const Entry& e : m_pending)
+		m_sorted[next[e.cell]++] = e.index;
+}
+
+void SpatialGrid::query(double x, double y, double radius, vector<int>& out) const
+{
+	out.clear();
+	CellRange r = cellsAround(x, y, collisionReach(radius, m_maxRadius));
+	for (int row = r.minRow; row <= r.maxRow; ++row)
+		for (int col = r.minCol; col <= r.maxCol; ++col)
+		{
+			int cell = row * GRID_COLS + col;
+			out.insert(out.end(), m_sorted.begin() + m_cellStart[cell], m_sorted.begin() + m_cellStart[cell + 1]);
+		}
+	sort(out.begin(), out.end());	// callers rely on visiting things in the same order a full scan would
+}
+
+int SpatialGrid::colOf(double x)
+{
+	int col = static_cast<int>(floor(x / GRID_CELL_SIZE));
+	return max(0, min(GRID_COLS - 1, col));
+}
+
+int SpatialGrid::rowOf(double y)
+{
+	int row = static_cast<int>(floor(y / GRID_CELL_SIZE));
+	return max(0, min(GRID_ROWS - 1, row));
+}
+
+CellRange SpatialGrid::cellsAround(double x, double y, double reach)
+{
+	CellRange r;
+	r.minCol = colOf(x - reach);
+	r.maxCol = colOf(x + reach);
+	r.minRow = rowOf(y - reach);
+	r.maxRow = rowOf(y + reach);
+	return r;
+}
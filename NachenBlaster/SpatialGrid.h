@@ -0,0 +1,68 @@
+#ifndef SPATIALGRID_H_
+#define SPATIALGRID_H_
+
+#include "GameConstants.h"
+#include <vector>
+
+  // Uniform grid over the 256x256 view used as a collision broadphase.
+  // Things are added by index (into whatever array the caller is scanning),
+  // then build() buckets them by cell so a query only visits nearby cells.
+  // Anything off screen is clamped into the border cells, so queries stay correct.
+
+const int GRID_CELL_SIZE = 32;	// bigger than any collision distance (.75 * (12 + 12) = 18)
+const int GRID_COLS = VIEW_WIDTH / GRID_CELL_SIZE;
+const int GRID_ROWS = VIEW_HEIGHT / GRID_CELL_SIZE;
+
+  // collide() tests .75 * (r1 + r2), so this is how far apart two things can be and still touch
+inline double collisionReach(double radius1, double radius2)
+{
+	return .75 * (radius1 + radius2);
+}
+
+  // Inclusive block of cells
+struct CellRange
+{
+	int minCol, maxCol;
+	int minRow, maxRow;
+
+	bool contains(int col, int row) const
+	{
+		return col >= minCol && col <= maxCol && row >= minRow && row <= maxRow;
+	}
+};
+
+class SpatialGrid
+{
+public:
+	SpatialGrid();
+
+	void clear();
+	void add(int index, double x, double y, double radius);
+	void build();	// must be called after the last add() and before any query
+
+	  // fills out with the indices (in ascending order) of everything that could
+	  // touch a circle of radius at (x, y)
+	void query(double x, double y, double radius, std::vector<int>& out) const;
+
+	double maxRadius() const
+	{
+		return m_maxRadius;
+	}
+
+	static int colOf(double x);
+	static int rowOf(double y);
+	static CellRange cellsAround(double x, double y, double reach);
+
+private:
+	struct Entry
+	{
+		int index;
+		int cell;
+	};
+	std::vector<Entry>	m_pending;		// added since the last clear()
+	std::vector<int>	m_cellStart;	// m_sorted[m_cellStart[c] .. m_cellStart[c+1]) are in cell c
+	std::vector<int>	m_sorted;		// indices grouped by cell
+	double				m_maxRadius;
+};
+
+#endif // SPATIALGRID_H_
@@ -0,0 +1,21 @@
+#ifndef SPRITEBATCH_H_
+#define SPRITEBATCH_H_
+
+  // A run of sprites sharing one image and frame, drawn unrotated with a single
+  // texture bind. Positions are as of the latest tick. During that tick sprite i
+  // moved by (dx[i], dy[i]), or by (dxPerTick, 0) when dx and dy are nullptr;
+  // that's how far back along its path it's drawn between ticks.
+
+struct SpriteBatch
+{
+	int				imageID;
+	const float*	x;
+	const float*	y;
+	const float*	size;
+	unsigned int	count;
+	double			dxPerTick;
+	const float*	dx;
+	const float*	dy;
+};
+
+#endif // SPRITEBATCH_H_
@@ -12,6 +12,7 @@
 #endif
 
 #include "GameConstants.h"
+#include "SpriteBatch.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -226,6 +227,59 @@ public:
 		return true;
 	}
 
+	  // Draws every sprite in the batch with one texture bind and one glBegin, each
+	  // alpha of the way from where it was at the previous tick to where it is now
+	bool plotSpriteBatch(const SpriteBatch& batch, int frame, double alpha)
+	{
+		int spriteID = getSpriteID(batch.imageID, frame);
+		if (INVALID_SPRITE_ID == spriteID)
+			return false;
+
+		auto it = m_imageMap.find(spriteID);
+		if (it == m_imageMap.end())
+			return false;
+
+		glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glEnable(GL_TEXTURE_2D);
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glBindTexture(GL_TEXTURE_2D, it->second);
+
+		glColor3f(1.0, 1.0, 1.0);
+
+		glBegin(GL_QUADS);
+		for (unsigned int i = 0; i < batch.count; i++)
+		{
+			double dx = (batch.dx != nullptr ? batch.dx[i] : batch.dxPerTick);
+			double dy = (batch.dy != nullptr ? batch.dy[i] : 0);
+			double gx, gy, gz;
+			convertToGlutCoords(batch.x[i] + dx * (alpha - 1), batch.y[i] + dy * (alpha - 1), gx, gy, gz);
+			GLfloat halfWidth = static_cast<GLfloat>(SPRITE_WIDTH_GL * batch.size[i] / 2);
+			GLfloat halfHeight = static_cast<GLfloat>(SPRITE_HEIGHT_GL * batch.size[i] / 2);
+			GLfloat left = static_cast<GLfloat>(gx) - halfWidth, right = static_cast<GLfloat>(gx) + halfWidth;
+			GLfloat bottom = static_cast<GLfloat>(gy) - halfHeight, top = static_cast<GLfloat>(gy) + halfHeight;
+			GLfloat z = static_cast<GLfloat>(gz);
+
+			glTexCoord2d(0, 0);
+			glVertex3f(left, bottom, z);
+			glTexCoord2d(1, 0);
+			glVertex3f(right, bottom, z);
+			glTexCoord2d(1, 1);
+			glVertex3f(right, top, z);
+			glTexCoord2d(0, 1);
+			glVertex3f(left, top, z);
+		}
+		glEnd();
+
+		glDisable(GL_TEXTURE_2D);
+		glEnable(GL_DEPTH_TEST);
+
+		glPopAttrib();
+
+		return true;
+	}
+
 	~SpriteManager()
 	{
 		for (auto it = m_imageMap.begin(); it != m_imageMap.end(); it++)
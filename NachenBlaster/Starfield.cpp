@@ -0,0 +1,108 @@
+#include "Starfield.h"
+#include "GameConstants.h"
+#include "WorldSnapshot.h"
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// about 30 on screen plus one every 15 ticks for the 256 it takes each to cross; this is plenty
+const int STAR_CAPACITY = 128;
+// more than this in a snapshot means it's corrupt
+const uint32_t MAX_SNAPSHOT_STARS = 4096;
+
+Starfield::Starfield()
+{
+	m_x.reserve(STAR_CAPACITY);
+	m_y.reserve(STAR_CAPACITY);
+	m_size.reserve(STAR_CAPACITY);
+}
+
+void Starfield::reset(Rng& rng)
+{
+	clear();
+	for (int i = 0; i < INITIAL_STARS; ++i)	// random positions anywhere on screen
+	{
+		int x = rng.nextInt(0, VIEW_WIDTH - 1);
+		int y = rng.nextInt(0, VIEW_HEIGHT - 1);
+		addStar(static_cast<float>(x), static_cast<float>(y), rng);
+	}
+}
+
+void Starfield::update(Rng& rng)
+{
+	// no branches or calls in here, so the compiler turns it into SIMD adds
+	float* x = m_x.data();
+	unsigned int n = m_x.size();
+	for (unsigned int i = 0; i < n; ++i)
+		x[i] -= STAR_SPEED;
+
+	// a star is drawn at x == 0 for one tick, then it's gone; slide the rest down, keeping their order
+	unsigned int nKept = 0;
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		if (x[i] < 0)
+			continue;
+		m_x[nKept] = m_x[i];
+		m_y[nKept] = m_y[i];
+		m_size[nKept] = m_size[i];
+		nKept++;
+	}
+	m_x.resize(nKept);
+	m_y.resize(nKept);
+	m_size.resize(nKept);
+
+	if (rng.nextInt(1, 15) == 1)	// 1/15 chance of a new star
+		addStar(VIEW_WIDTH - 1, static_cast<float>(rng.nextInt(0, VIEW_HEIGHT - 1)), rng);
+}
+
+void Starfield::clear()
+{
+	m_x.clear();
+	m_y.clear();
+	m_size.clear();
+}
+
+unsigned int Starfield::size() const
+{
+	return m_x.size();
+}
+
+SpriteBatch Starfield::getBatch() const
+{
+	SpriteBatch batch;
+	batch.imageID = IID_STAR;
+	batch.x = m_x.data();
+	batch.y = m_y.data();
+	batch.size = m_size.data();
+	batch.count = m_x.size();
+	batch.dxPerTick = -STAR_SPEED;
+	batch.dx = nullptr;	// they all move the same way
+	batch.dy = nullptr;
+	return batch;
+}
+
+void Starfield::save(SnapshotWriter& out) const
+{
+	out.writeArray(m_x.data(), m_x.size());
+	out.writeArray(m_y.data(), m_y.size());
+	out.writeArray(m_size.data(), m_size.size());
+}
+
+void Starfield::load(SnapshotReader& in)
+{
+	in.readArray(m_x, MAX_SNAPSHOT_STARS);
+	in.readArray(m_y, MAX_SNAPSHOT_STARS);
+	in.readArray(m_size, MAX_SNAPSHOT_STARS);
+	if (m_y.size() != m_x.size() || m_size.size() != m_x.size())
+	{
+		in.fail();
+		clear();
+	}
+}
+
+void Starfield::addStar(float x, float y, Rng& rng)
+{
+	m_x.push_back(x);
+	m_y.push_back(y);
+	m_size.push_back(rng.nextInt(5, 50) / 100.0f);
+}
@@ -0,0 +1,38 @@
+#ifndef STARFIELD_H_
+#define STARFIELD_H_
+
+#include "GameWorld.h"
+#include "Random.h"
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+  // The scrolling background. Stars can't hit or be hit by anything, so rather
+  // than being Actors they're just three parallel arrays, moved in one pass per
+  // tick and drawn as a single SpriteBatch behind everything else.
+
+class Starfield
+{
+public:
+	static const int INITIAL_STARS = 30;
+	static const int STAR_SPEED = 1;	// pixels per tick, right to left
+
+	Starfield();
+	void reset(Rng& rng);	// replaces any stars with INITIAL_STARS scattered across the screen
+	void update(Rng& rng);	// moves every star, drops the ones that left the screen, maybe adds one on the right
+	void clear();
+	unsigned int size() const;
+	SpriteBatch getBatch() const;
+	void save(SnapshotWriter& out) const;
+	void load(SnapshotReader& in);
+
+private:
+	void addStar(float x, float y, Rng& rng);	// picks a random size (.05-.5)
+
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<float> m_size;
+};
+
+#endif // STARFIELD_H_
@@ -0,0 +1,51 @@
+#ifndef STATEHASH_H_
+#define STATEHASH_H_
+
+#include <cstdint>
+#include <cmath>
+
+  // 64 bit hashing for determinism checks (see StudentWorld::getStateHash).
+  // Nothing depends on it being secure; two different worlds just have to
+  // (almost) never hash the same. Values are mixed in one at a time, in order.
+
+class StateHash
+{
+public:
+	StateHash()
+		: m_hash(0x9e3779b97f4a7c15ULL)
+	{
+	}
+
+	void add(std::uint64_t value)
+	{
+		m_hash = mix(m_hash ^ mix(value));
+	}
+
+	std::uint64_t get() const
+	{
+		return m_hash;
+	}
+
+	  // splitmix64's finalizer: every input bit affects every output bit
+	static std::uint64_t mix(std::uint64_t x)
+	{
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		return x;
+	}
+
+	  // Positions go in rounded to 1/256 of a pixel, so a change that only moves
+	  // the last bits of a double around doesn't count as the game changing
+	static std::uint64_t quantize(double coordinate)
+	{
+		return static_cast<std::uint64_t>(std::llround(coordinate * 256));
+	}
+
+private:
+	std::uint64_t m_hash;
+};
+
+#endif // STATEHASH_H_
@@ -1,23 +1,57 @@
 #include "StudentWorld.h"
 #include "GameConstants.h"
+#include "TickProfiler.h"
+#include "CollisionKernel.h"
+#include "StateHash.h"
 #include <string>
 #include <vector>
-#include <sstream>
+#include <random>
+#include <cstdint>
+#include <tuple>
 using namespace std;
 
+// room reserved up front so ordinary ticks never grow the actor vectors
+const int ACTORS_PER_KIND_CAPACITY = 64;
+const int PENDING_ACTOR_CAPACITY = 64;
+// friendly projectiles per parallel task; there are rarely more than a couple of dozen
+const unsigned int PROJECTILES_PER_TASK = 8;
+
 GameWorld* createStudentWorld(string assetDir)
 {
-	return new StudentWorld(assetDir);
+	random_device rd;	// a fresh game every run; pass a seed to StudentWorld to replay one
+	return new StudentWorld(assetDir, (static_cast<uint64_t>(rd()) << 32) | rd());
 }
 
-StudentWorld::StudentWorld(string assetDir)
-: GameWorld(assetDir)
+StudentWorld::StudentWorld(string assetDir, uint64_t seed)
+: GameWorld(assetDir), m_seed(seed),
+  m_spawnRng(seed, RNG_STREAM_SPAWN), m_aiRng(seed, RNG_STREAM_AI), m_cosmeticRng(seed, RNG_STREAM_COSMETIC),
+  m_pools("Cabbage", "Turnip", "FTorpedoProjectile",
+		  "Repair", "ExtraLife", "FTorpedoGoodie", "Smallgon", "Smoregon", "Snagglegon")
 {
 	// initialize member variables to harmless things
 	m_user = nullptr;
+	m_tickCount = 0;
+	m_stateHash = 0;
+	m_runHash = 0;
+	m_recording = nullptr;
+	m_playback = nullptr;
+	m_playbackStart = 0;
+	m_input = &m_keyboard;
+	m_levels = nullptr;
+	m_levelInfo = LevelInfo();
+	m_levelTick = 0;
+	m_waveCursor = 0;
+	m_threadPool = &m_inlinePool;
 	m_nAliensOnScreen = 0;
 	m_maxNOfAliens = 0;
 	m_nOfAliensLeft = 0;
+	m_collisionStats.bruteForcePairs = 0;
+	m_collisionStats.testedPairs = 0;
+	for (int kind = 0; kind < NUM_ACTOR_KINDS; ++kind)
+		m_actors[kind].reserve(ACTORS_PER_KIND_CAPACITY);
+	m_pendingActors.reserve(PENDING_ACTOR_CAPACITY);
+	m_actorTable.reserve(NUM_ACTOR_KINDS * ACTORS_PER_KIND_CAPACITY);
+	m_projectileSlots.reserve(ACTORS_PER_KIND_CAPACITY);
 }
 
 StudentWorld::~StudentWorld()
@@ -25,14 +59,72 @@ StudentWorld::~StudentWorld()
 	cleanUp();
 }
 
+// the host, pool, rewind budget, level schedule and input source stay as they were set; the actor vectors,
+// pools and table keep their capacity, so a world played over and over stops allocating
+void StudentWorld::reset(uint64_t seed)
+{
+	cleanUp();
+	restoreProgress(START_PLAYER_LIVES, 0, 1);
+	m_seed = seed;
+	m_spawnRng = Rng(seed, RNG_STREAM_SPAWN);
+	m_aiRng = Rng(seed, RNG_STREAM_AI);
+	m_cosmeticRng = Rng(seed, RNG_STREAM_COSMETIC);
+	m_tickCount = 0;
+	m_stateHash = 0;
+	m_runHash = 0;
+	m_recording = nullptr;
+	m_playback = nullptr;
+	m_playbackStart = 0;
+	m_replayInput.setReplay(nullptr);
+	m_levelInfo = LevelInfo();
+	m_levelTick = 0;
+	m_waveCursor = 0;
+	m_nAliensOnScreen = 0;
+	m_maxNOfAliens = 0;
+	m_nOfAliensLeft = 0;
+	m_collisionStats.bruteForcePairs = 0;
+	m_collisionStats.testedPairs = 0;
+	m_rewind.clear();
+	m_hud = HudModel();
+}
+
 // fill the world with stars, set level parameters, display status line, create a user
 int StudentWorld::init()
 {
+	if (m_playbackStart > 0)	// playing back from part way in
+	{
+		const ReplayKeyframe* keyframe = m_playback->findKeyframe(m_playbackStart);
+		m_playbackStart = 0;
+		if (keyframe != nullptr && loadSnapshot(keyframe->snapshot))
+		{
+			m_playback->rewindTo(m_tickCount);
+			displayStatusLine();
+			return GWSTATUS_CONTINUE_GAME;
+		}
+	}
+	if (m_levels != nullptr)
+	{
+		if (!m_levels->isOpen())
+			return GWSTATUS_LEVEL_ERROR;
+		if (!m_levels->getLevel(getLevel(), m_levelInfo))
+			return GWSTATUS_PLAYER_WON;	// finished the last one
+	}
 	m_user = new NachenBlaster(this);
-	createInitialStars();
-	m_nOfAliensLeft = (6 + (4 * getLevel()));
-	m_maxNOfAliens  = (4 + (.5 * getLevel()));
+	m_starfield.reset(m_cosmeticRng);
+	addPendingActors();
+	if (m_levels != nullptr)
+	{
+		m_nOfAliensLeft = m_levelInfo.kills;
+		m_maxNOfAliens  = m_levelInfo.maxOnScreen;
+	}
+	else
+	{
+		m_nOfAliensLeft = (6 + (4 * getLevel()));
+		m_maxNOfAliens  = (4 + (.5 * getLevel()));
+	}
 	m_nAliensOnScreen = 0;
+	m_levelTick = 0;
+	m_waveCursor = 0;
 	displayStatusLine();
     return GWSTATUS_CONTINUE_GAME;
 }
@@ -40,27 +132,76 @@ int StudentWorld::init()
 // runs every game tick
 int StudentWorld::move()
 {
-	displayStatusLine();	// update status bar each tick
-	possiblyCreateStar();	// chance to create a new star
-	possiblyCreateAlien();	// create a random new alien if it needs to be created
-	checkFriendlyProjectiles();	// check if friendly projectiles hit anything 
-	m_user->doSomething();	// take user input
+	PROFILE_PHASE(getProfiler(), PHASE_TICK);
+
+	if (m_recording != nullptr && m_tickCount % REPLAY_KEYFRAME_INTERVAL == 0)
+		saveSnapshot(m_recording->addKeyframe(m_tickCount));
+	if (m_rewind.isEnabled())
+	{
+		saveFrame(m_rewind.nextFrame());
+		m_rewind.commit(m_tickCount);
+	}
 
-	// make every actor do something: check if user collides with enemies, projectiles, or goodies
-	for (unsigned int i = 0; i < m_allActors.size(); ++i)
+	// The tick is a small task graph. Stars and explosion particles touch nothing else in the
+	// world, so they're updated alongside everything up to removeDeadActors (which adds particles).
+	// The rest runs in order, with the independent parts inside each step fanned out over the
+	// pool: projectile movement, and the search half of checkFriendlyProjectiles. Anything that
+	// spawns, scores, plays a sound or uses a gameplay random stream stays on this thread, in
+	// the same order as always, so every thread count plays the same game.
+	TaskGroup effects;
+	m_threadPool->submit(effects, &StudentWorld::updateEffects, this);
+	{
+		PROFILE_PHASE(getProfiler(), PHASE_STATUS_LINE);
+		displayStatusLine();	// update status bar each tick
+	}
 	{
-		m_user->collide(*(m_allActors[i]));		// see if user hits anything before and after moving
-		m_allActors[i]->doSomething();
-		m_user->collide(*(m_allActors[i]));
+		PROFILE_PHASE(getProfiler(), PHASE_SPAWN);
+		possiblyCreateAlien();	// create a random new alien if it needs to be created
 	}
-	// check if projectiles hit AFTER doing their action
-	checkFriendlyProjectiles();
+	countBruteForcePairs();
+	{
+		PROFILE_PHASE(getProfiler(), PHASE_PROJECTILES_BEFORE);
+		checkFriendlyProjectiles();	// check if friendly projectiles hit anything 
+	}
+	{
+		PROFILE_PHASE(getProfiler(), PHASE_ACTORS);
+		m_user->doSomething();	// take user input
 
-	removeDeadActors();		// remove any actors that need to be removed
+		// make every actor do something, one kind at a time: check if user collides with enemies, projectiles, or goodies
+		moveFriendlyProjectiles();	// our shots are checked below
+		updateKinds(FIRST_ENEMY_PROJECTILE_KIND, KIND_NACHENBLASTER, true);
+		// anything created this tick (aliens, shots, goodies) joins now, so it first moves next tick
+		addPendingActors();
+	}
+	{
+		PROFILE_PHASE(getProfiler(), PHASE_PROJECTILES_AFTER);
+		// check if projectiles hit AFTER doing their action
+		checkFriendlyProjectiles();
+	}
+	m_threadPool->wait(effects);
+	{
+		PROFILE_PHASE(getProfiler(), PHASE_REMOVE_DEAD);
+		removeDeadActors();		// remove any actors that need to be removed
+	}
+	{
+		PROFILE_PHASE(getProfiler(), PHASE_EVENTS);
+		applyEvents();	// everything the tick did to sounds, score, lives and torpedoes
+	}
 	// return game status
-	if (m_nOfAliensLeft <= 0) { playSound(SOUND_FINISHED_LEVEL);  return GWSTATUS_FINISHED_LEVEL; }
-	else if (m_user->isAlive())	return GWSTATUS_CONTINUE_GAME;
-	else /*>~~~(>__<)~~~~<*/  { decLives();	return GWSTATUS_PLAYER_DIED; }
+	int status;
+	if (m_nOfAliensLeft <= 0) { playSound(SOUND_FINISHED_LEVEL);  status = GWSTATUS_FINISHED_LEVEL; }
+	else if (m_user->isAlive())	status = GWSTATUS_CONTINUE_GAME;
+	else /*>~~~(>__<)~~~~<*/  { decLives();	status = GWSTATUS_PLAYER_DIED; }
+	m_tickCount++;
+	m_levelTick++;
+	m_stateHash = hashState();
+	StateHash run;
+	run.add(m_runHash);
+	run.add(m_stateHash);
+	m_runHash = run.get();
+	if (m_recording != nullptr)
+		m_recording->setEnd(m_tickCount, getScore(), getLevel(), getLives());
+	return status;
 }
 
 // delete user and everything in the actor vector
@@ -68,49 +209,388 @@ void StudentWorld::cleanUp()
 {
 	delete m_user;
 	m_user = nullptr;	// so that if we try to delete later, nothing bad happens
-	for (unsigned int i = 0; i < m_allActors.size(); ++i)
-		delete m_allActors[i];
-	while (!m_allActors.empty())	// while vector isn't empty
+	for (int kind = 0; kind < NUM_ACTOR_KINDS; ++kind)
 	{
-		vector<Actor*>::iterator it = m_allActors.begin();
-		m_allActors.erase(it);
+		for (unsigned int i = 0; i < m_actors[kind].size(); ++i)
+			destroyActor(m_actors[kind][i]);
+		m_actors[kind].clear();
 	}
+	for (unsigned int i = 0; i < m_pendingActors.size(); ++i)
+		destroyActor(m_pendingActors[i]);
+	m_pendingActors.clear();
+	m_events.clear();
+	m_actorTable.clear();	// every outstanding handle is now stale
+	m_starfield.clear();
+	m_particles.clear();
+}
+
+void StudentWorld::getBackground(vector<SpriteBatch>& batches) const
+{
+	batches.push_back(m_starfield.getBatch());
+}
+
+void StudentWorld::getForeground(vector<SpriteBatch>& batches) const
+{
+	m_particles.getBatches(batches);
 }
 
 ///////////////////////////////////
 // Helper Functions
 ///////////////////////////////////
 
-NachenBlaster* StudentWorld::getUser() const
+uint64_t StudentWorld::getSeed() const
 {
-	return m_user;
+	return m_seed;
+}
+Rng& StudentWorld::getSpawnRng()
+{
+	return m_spawnRng;
+}
+Rng& StudentWorld::getAIRng()
+{
+	return m_aiRng;
+}
+Rng& StudentWorld::getCosmeticRng()
+{
+	return m_cosmeticRng;
 }
-void StudentWorld::createInitialStars()
+void StudentWorld::setThreadPool(ThreadPool* pool)
 {
-	for (int i = 0; i < 30; ++i)	// create 30 stars with random positions
+	m_threadPool = (pool != nullptr ? pool : &m_inlinePool);
+}
+unsigned long StudentWorld::getTick() const
+{
+	return m_tickCount;
+}
+uint64_t StudentWorld::getStateHash() const
+{
+	return m_stateHash;
+}
+uint64_t StudentWorld::getRunHash() const
+{
+	return m_runHash;
+}
+uint64_t StudentWorld::hashState() const
+{
+	// actors are summed, so which slot or vector each one sits in doesn't matter
+	const ActorHotData& hot = m_actorTable.hot();
+	uint64_t actors = 0;
+	for (unsigned int i = 0; i < hot.actor.size(); ++i)
 	{
-		Star* temp = new Star(randInt(0, VIEW_WIDTH - 1), randInt(0, VIEW_HEIGHT - 1), this);
-		m_allActors.push_back(temp);
+		if (hot.actor[i] == nullptr)
+			continue;
+		StateHash actor;
+		actor.add(hot.kind[i] | (static_cast<uint64_t>(hot.alive[i]) << 8) | (static_cast<uint64_t>(static_cast<uint32_t>(hot.health[i])) << 32));
+		actor.add(StateHash::quantize(hot.x[i]));
+		actor.add(StateHash::quantize(hot.y[i]));
+		actors += actor.get();
 	}
+	StateHash h;
+	h.add(actors);
+	if (m_user != nullptr)
+		h.add(static_cast<uint32_t>(m_user->getCabbageEnergy()) | (static_cast<uint64_t>(m_user->getNOfTorpedoes()) << 32));
+	h.add(getLives() | (static_cast<uint64_t>(getLevel()) << 32));
+	h.add(getScore());
+	h.add(static_cast<uint32_t>(m_nOfAliensLeft) | (static_cast<uint64_t>(static_cast<uint32_t>(m_nAliensOnScreen)) << 32));
+	h.add(static_cast<uint32_t>(m_levelTick) | (static_cast<uint64_t>(m_waveCursor) << 32));
+	h.add(m_spawnRng.getState());
+	h.add(m_aiRng.getState());
+	return h.get();
 }
-void StudentWorld::displayStatusLine()
+void StudentWorld::setLevels(const LevelSchedule* levels)
+{
+	m_levels = levels;
+}
+void StudentWorld::setRecording(Replay* replay)
+{
+	m_recording = replay;
+	if (m_recording != nullptr)
+		m_recording->start(m_seed);
+}
+void StudentWorld::setPlayback(Replay* replay, unsigned long startTick)
+{
+	m_playback = replay;
+	m_playbackStart = (replay != nullptr ? startTick : 0);
+	m_replayInput.setReplay(replay);
+	if (m_playback != nullptr)
+		m_playback->rewindTo(0);
+}
+void StudentWorld::setInput(InputSource* input)
+{
+	m_input = (input != nullptr ? input : &m_keyboard);
+}
+bool StudentWorld::getAction(PlayerAction& action)
+{
+	InputSource* input = (m_playback != nullptr ? &m_replayInput : m_input);
+	if (!input->nextAction(*this, action))
+		return false;
+	if (action.quit)
+	{
+		getController()->quitGame();
+		return false;
+	}
+	if (action.pack() == 0)	// a key that doesn't do anything
+		return false;
+	if (m_recording != nullptr)
+		m_recording->addAction(m_tickCount, action);
+	return true;
+}
+// Snapshots and frames hold the same things in the same order. Where they differ is where each
+// actor's state goes: straight after its slot in a snapshot, under its slot in a frame (so the
+// rewind buffer can tell which actors changed), and the starfield and particles, which frames
+// keep apart from the rest. writeState/readState put each actor's state wherever it belongs.
+template<typename WriteState>
+void StudentWorld::saveWorld(SnapshotWriter& w, SnapshotWriter& effects, WriteState writeState) const
+{
+	// only between ticks: m_pendingActors is always empty then
+	w.write(getLives());
+	w.write(getScore());
+	w.write(getLevel());
+	w.write(m_seed);
+	w.write(static_cast<uint64_t>(m_tickCount));
+	w.write(m_runHash);
+	w.write(m_nAliensOnScreen);
+	w.write(m_maxNOfAliens);
+	w.write(m_nOfAliensLeft);
+	w.write(static_cast<uint64_t>(m_levelTick));
+	w.write(m_waveCursor);
+
+	m_actorTable.save(w);
+	w.write(m_user->getHandle().index);
+	writeState(*m_user);
+	for (int kind = 0; kind < KIND_NACHENBLASTER; ++kind)	// the user has a kind but isn't in a vector
+	{
+		w.write(static_cast<uint32_t>(m_actors[kind].size()));
+		for (Actor* actor : m_actors[kind])
+		{
+			w.write(actor->getHandle().index);
+			writeState(*actor);
+		}
+	}
+	m_starfield.save(effects);
+	m_particles.save(effects);
+
+	const Rng* rngs[] = { &m_spawnRng, &m_aiRng, &m_cosmeticRng };
+	for (const Rng* rng : rngs)
+	{
+		w.write(rng->getState());
+		w.write(rng->getIncrement());
+	}
+}
+template<typename ReadState>
+bool StudentWorld::restoreWorld(SnapshotReader& r, SnapshotReader& effects, ReadState readState)
+{
+	cleanUp();
+	unsigned int lives = r.read<unsigned int>();
+	unsigned int score = r.read<unsigned int>();
+	unsigned int level = r.read<unsigned int>();
+	restoreProgress(lives, score, level);
+	r.read(m_seed);
+	m_tickCount = static_cast<unsigned long>(r.read<uint64_t>());
+	r.read(m_runHash);
+	r.read(m_nAliensOnScreen);
+	r.read(m_maxNOfAliens);
+	r.read(m_nOfAliensLeft);
+	m_levelTick = static_cast<unsigned long>(r.read<uint64_t>());
+	r.read(m_waveCursor);
+	if (level == 0)	// levels count from 1, and the aliens divide by it
+		return false;
+	m_levelInfo = LevelInfo();	// no waves unless the schedule has this level
+	if (m_levels != nullptr && !m_levels->getLevel(level, m_levelInfo))
+		return false;
+	if (m_waveCursor > m_levelInfo.nWaves)
+		return false;
+
+	// every actor goes back in the slot it had, so handles and scan order come out the same
+	m_actorTable.beginRestore(r);
+	if (r.failed() || !m_actorTable.placeNext(r.read<unsigned int>()))
+		return false;
+	m_user = new NachenBlaster(this);
+	if (!readState(*m_user))
+		return false;
+	for (int kind = 0; kind < KIND_NACHENBLASTER; ++kind)
+	{
+		uint32_t n = r.read<uint32_t>();
+		for (uint32_t i = 0; i < n && !r.failed(); ++i)
+		{
+			if (!m_actorTable.placeNext(r.read<unsigned int>()))
+				return false;
+			Actor* actor = createActorOfKind(kind);
+			m_actors[kind].push_back(actor);
+			if (!readState(*actor))
+				return false;
+		}
+	}
+	if (r.failed() || !m_actorTable.endRestore())
+		return false;
+	m_starfield.load(effects);
+	m_particles.load(effects);
+
+	// last, since the constructors above drew from them
+	Rng* rngs[] = { &m_spawnRng, &m_aiRng, &m_cosmeticRng };
+	for (Rng* rng : rngs)
+	{
+		uint64_t state = r.read<uint64_t>();
+		uint64_t increment = r.read<uint64_t>();
+		rng->setState(state, increment);
+	}
+	m_stateHash = hashState();
+	return !r.failed() && r.atEnd() && !effects.failed() && effects.atEnd();
+}
+void StudentWorld::saveSnapshot(WorldSnapshot& out) const
+{
+	out.bytes.clear();
+	SnapshotWriter w(out.bytes);
+	w.write(SNAPSHOT_MAGIC);
+	w.write(SNAPSHOT_VERSION);
+	saveWorld(w, w, [&](const Actor& actor) { actor.saveState(w); });
+}
+bool StudentWorld::loadSnapshot(const WorldSnapshot& in)
+{
+	// check the header before touching anything
+	SnapshotReader r(in.bytes.data(), in.bytes.size());
+	if (r.read<uint32_t>() != SNAPSHOT_MAGIC || r.read<uint32_t>() != SNAPSHOT_VERSION)
+		return false;
+	return restoreWithUndo([&]() { return restoreSnapshot(in); });
+}
+bool StudentWorld::restoreSnapshot(const WorldSnapshot& in)
 {
-	int cEnergy = m_user->getCabbageEnergy() * 10 / 3;
-	ostringstream temp, cabbages;
-	temp.setf(ios::fixed);
-	temp.precision(2);
-	if (cEnergy < 10)
-		cabbages << '0' << cEnergy;
+	SnapshotReader r(in.bytes.data(), in.bytes.size());
+	r.read<uint32_t>();	// magic and version, already checked
+	r.read<uint32_t>();
+	return restoreWorld(r, r, [&](Actor& actor) { actor.loadState(r); return !r.failed(); });
+}
+void StudentWorld::saveFrame(WorldFrame& out) const
+{
+	out.globals.clear();
+	out.effects.clear();
+	out.actors.resize(m_actorTable.size());
+	for (vector<unsigned char>& state : out.actors)
+		state.clear();
+	SnapshotWriter w(out.globals);
+	SnapshotWriter effects(out.effects);
+	saveWorld(w, effects, [&](const Actor& actor)
+	{
+		SnapshotWriter state(out.actors[actor.getHandle().index]);
+		actor.saveState(state);
+	});
+}
+bool StudentWorld::loadFrame(const WorldFrame& in)
+{
+	return restoreWithUndo([&]()
+	{
+		SnapshotReader r(in.globals.data(), in.globals.size());
+		SnapshotReader effects(in.effects.data(), in.effects.size());
+		return restoreWorld(r, effects, [&](Actor& actor)
+		{
+			if (actor.getHandle().index >= in.actors.size())
+				return false;
+			const vector<unsigned char>& bytes = in.actors[actor.getHandle().index];
+			SnapshotReader state(bytes.data(), bytes.size());
+			actor.loadState(state);
+			return !state.failed() && state.atEnd();
+		});
+	});
+}
+template<typename Restore>
+bool StudentWorld::restoreWithUndo(Restore restore)
+{
+	bool hadWorld = (m_user != nullptr);
+	if (hadWorld)
+		saveSnapshot(m_undoSnapshot);
+	if (restore())
+		return true;
+	// the rest of it was corrupt: put back what we had
+	if (hadWorld)
+		restoreSnapshot(m_undoSnapshot);
 	else
-		cabbages << cEnergy;
-	temp
-		<< "Lives: "	 << getLives()				<<  "   "
-		<< "Health: "	 << m_user->getHealth() *2	<< "%   "
-		<< "Score: "	 << getScore()				<<  "   "
-		<< "Level: "	 << getLevel()				<<  "   "
-		<< "Cabbages: "	 << cabbages.str()			<< "%   "
-		<< "Torpedoes: " << m_user->getNOfTorpedoes();
-	setGameStatText(temp.str());
+		cleanUp();
+	return false;
+}
+bool StudentWorld::quickSave(const string& path) const
+{
+	WorldSnapshot snapshot;
+	saveSnapshot(snapshot);
+	return snapshot.writeFile(path);
+}
+bool StudentWorld::quickLoad(const string& path)
+{
+	if (m_recording != nullptr || m_playback != nullptr)	// the replay couldn't follow the jump
+		return false;
+	WorldSnapshot snapshot;
+	if (!snapshot.readFile(path) || !loadSnapshot(snapshot))
+		return false;
+	m_rewind.clear();	// a different game, or a different point in this one
+	return true;
+}
+bool StudentWorld::rewind(unsigned int ticks)
+{
+	if (m_rewind.empty())
+		return false;
+	unsigned long oldest = m_rewind.getOldestTick();
+	return rewindTo(m_tickCount > oldest + ticks ? m_tickCount - ticks : oldest);
+}
+bool StudentWorld::rewindTo(unsigned long tick)
+{
+	if (m_recording != nullptr)	// the recording has already been given the keys after tick
+		return false;
+	if (!m_rewind.reconstruct(tick, m_rewindFrame) || !loadFrame(m_rewindFrame))
+		return false;
+	m_rewind.discardFrom(tick);	// it's about to be played again, perhaps differently
+	if (m_playback != nullptr)
+		m_playback->rewindTo(m_tickCount);
+	return true;
+}
+void StudentWorld::setRewindBudget(size_t bytes)
+{
+	m_rewind.setBudget(bytes);
+}
+const RewindBuffer& StudentWorld::getRewindBuffer() const
+{
+	return m_rewind;
+}
+NachenBlaster* StudentWorld::getUser() const
+{
+	return m_user;
+}
+Actor* StudentWorld::getActor(ActorHandle handle) const
+{
+	return m_actorTable.get(handle);
+}
+void StudentWorld::displayStatusLine()
+{
+	// reformatted and sent on only when something on it has changed
+	if (m_hud.update(getLives(), m_user->getHealth() * 2, getScore(), getLevel(),
+					 m_user->getCabbageEnergy() * 10 / 3, m_user->getNOfTorpedoes()))
+		setGameStatText(m_hud.getText());
+}
+EventQueue& StudentWorld::getEvents()
+{
+	return m_events;
+}
+void StudentWorld::applyEvents()
+{
+	// each sound once, however many things made it this tick, in the order they first did
+	unsigned int soundsPlayed = 0;
+	for (const WorldEvent& e : m_events.events())
+	{
+		switch (e.type)
+		{
+		case EVENT_SOUND:
+			if (e.value >= 0 && e.value < 32)
+			{
+				if (soundsPlayed & (1u << e.value))
+					break;
+				soundsPlayed |= 1u << e.value;
+			}
+			playSound(e.value);
+			break;
+		case EVENT_SCORE:		increaseScore(e.value);				break;
+		case EVENT_EXTRA_LIFE:	incLives();							break;
+		case EVENT_TORPEDOES:	m_user->incTorpedoes(e.value);		break;
+		}
+	}
+	m_events.clear();
 }
 void StudentWorld::decrAliensLeft()
 {
@@ -118,82 +598,262 @@ void StudentWorld::decrAliensLeft()
 }
 void StudentWorld::createActor(Actor* newActor)
 {
-	m_allActors.push_back(newActor);
+	// don't touch m_actors here: move() may be in the middle of looping over it
+	m_pendingActors.push_back(newActor);
+}
+void StudentWorld::addPendingActors()
+{
+	for (unsigned int i = 0; i < m_pendingActors.size(); ++i)
+		m_actors[m_pendingActors[i]->getKind()].push_back(m_pendingActors[i]);
+	m_pendingActors.clear();	// keeps its capacity for the next tick
+}
+void StudentWorld::destroyActor(Actor* actor)
+{
+	// hand the actor back to the pool it came from
+	switch (actor->getKind())
+	{
+	case KIND_CABBAGE:			releaseActor(static_cast<Cabbage*>(actor));				break;
+	case KIND_FRIENDLY_TORPEDO:
+	case KIND_ENEMY_TORPEDO:	releaseActor(static_cast<FTorpedoProjectile*>(actor));	break;
+	case KIND_TURNIP:			releaseActor(static_cast<Turnip*>(actor));				break;
+	case KIND_REPAIR_GOODIE:	releaseActor(static_cast<Repair*>(actor));				break;
+	case KIND_LIFE_GOODIE:		releaseActor(static_cast<ExtraLife*>(actor));			break;
+	case KIND_TORPEDO_GOODIE:	releaseActor(static_cast<FTorpedoGoodie*>(actor));		break;
+	case KIND_SMALLGON:			releaseActor(static_cast<Smallgon*>(actor));			break;
+	case KIND_SMOREGON:			releaseActor(static_cast<Smoregon*>(actor));			break;
+	case KIND_SNAGGLEGON:		releaseActor(static_cast<Snagglegon*>(actor));			break;
+	default:					delete actor;											break;
+	}
+}
+Actor* StudentWorld::createActorOfKind(int kind)
+{
+	// the constructors' positions and random choices don't matter: loadState overwrites them
+	switch (kind)
+	{
+	case KIND_CABBAGE:			return spawnInPool<Cabbage>(0, 0, this);
+	case KIND_FRIENDLY_TORPEDO:	return spawnInPool<FTorpedoProjectile>(0, 0, this, 0);
+	case KIND_TURNIP:			return spawnInPool<Turnip>(0, 0, this);
+	case KIND_ENEMY_TORPEDO:	return spawnInPool<FTorpedoProjectile>(0, 0, this, 180);
+	case KIND_REPAIR_GOODIE:	return spawnInPool<Repair>(0, 0, this);
+	case KIND_LIFE_GOODIE:		return spawnInPool<ExtraLife>(0, 0, this);
+	case KIND_TORPEDO_GOODIE:	return spawnInPool<FTorpedoGoodie>(0, 0, this);
+	case KIND_SMALLGON:			return spawnInPool<Smallgon>(0, this);
+	case KIND_SMOREGON:			return spawnInPool<Smoregon>(0, this);
+	default:					return spawnInPool<Snagglegon>(0, this);	// KIND_SNAGGLEGON, the last kind in a vector
+	}
+}
+vector<PoolStats> StudentWorld::getPoolStats() const
+{
+	return vector<PoolStats> {
+		get<ObjectPool<Cabbage>>(m_pools).getStats(),
+		get<ObjectPool<Turnip>>(m_pools).getStats(),
+		get<ObjectPool<FTorpedoProjectile>>(m_pools).getStats(),
+		get<ObjectPool<Repair>>(m_pools).getStats(),
+		get<ObjectPool<ExtraLife>>(m_pools).getStats(),
+		get<ObjectPool<FTorpedoGoodie>>(m_pools).getStats(),
+		get<ObjectPool<Smallgon>>(m_pools).getStats(),
+		get<ObjectPool<Smoregon>>(m_pools).getStats(),
+		get<ObjectPool<Snagglegon>>(m_pools).getStats(),
+	};
 }
 void StudentWorld::removeDeadActors()
 {
-	for (unsigned int i = 0; i < m_allActors.size(); ++i)
+	// single pass per kind: slide every survivor down over the dead ones, keeping their order
+	for (int kind = 0; kind < NUM_ACTOR_KINDS; ++kind)
 	{
-		if (!m_allActors[i]->isAlive()) // if the actor is dead
+		vector<Actor*>& actors = m_actors[kind];
+		unsigned int nKept = 0;
+		for (unsigned int i = 0; i < actors.size(); ++i)
 		{
-			if (isAlien(m_allActors[i]))	// if actor was an alien
+			Actor* actor = actors[i];
+			if (actor->isAlive())
+			{
+				actors[nKept++] = actor;
+				continue;
+			}
+			if (isAlien(actor))	// if actor was an alien
 			{
 				m_nAliensOnScreen--;
 				// if dead alien is worth points, increase score and kill counter and replace with explosion
-				if (m_allActors[i]->getScore() != 0)	
+				if (actor->getScore() != 0)
 				{
 					m_nOfAliensLeft--;
-					increaseScore(m_allActors[i]->getScore());
-					playSound(SOUND_DEATH);
-					// replace existing actor with explosion
-					Explosion* temp = new Explosion(m_allActors[i]->getX(), m_allActors[i]->getY(), this);
-					delete m_allActors[i];
-					m_allActors[i] = temp;
-					continue;	// continue so we don't delete the explosion
+					m_events.score(actor->getScore());
+					m_events.sound(SOUND_DEATH);
+					m_particles.spawnExplosion(actor->getX(), actor->getY(), m_cosmeticRng);
 				}
 			}
-			// delete the actor and then take out its place from the vector
-			vector<Actor*>::iterator it = m_allActors.begin();
-			it += i;
-			delete m_allActors[i];
-			m_allActors.erase(it);
-			--i;	// decrement i so that we don't skip an element in the array
+			destroyActor(actor);
 		}
+		actors.resize(nKept);
 	}
 }
-void StudentWorld::possiblyCreateStar()
-{
-	int chance = randInt(1, 15);
-	if (chance != 1)		// 14/15 chance return
-		return;
-	Actor* tempStar = new Star(randInt(0, VIEW_HEIGHT - 1), this);
-	m_allActors.push_back(tempStar);
-}
 void StudentWorld::possiblyCreateAlien()
 {
 	if (m_nAliensOnScreen >= min(m_maxNOfAliens, m_nOfAliensLeft))	// if max aliens on screen, do nothing
 		return;
+	if (m_waveCursor < m_levelInfo.nWaves)	// the level's schedule comes first
+	{
+		// everything that's due, as long as there's room; the rest waits for a later tick
+		do
+		{
+			WaveSpawn wave = m_levels->getWave(m_levelInfo.firstWave + m_waveCursor);
+			if (wave.tick > m_levelTick)
+				return;
+			int y = ((wave.flags & WAVE_RANDOM_LANE) ? m_spawnRng.nextInt(0, VIEW_HEIGHT - 1) : wave.lane);
+			if (wave.alien == WAVE_SMALLGON)
+				spawnActor<Smallgon>(y, this);
+			else if (wave.alien == WAVE_SMOREGON)
+				spawnActor<Smoregon>(y, this);
+			else
+				spawnActor<Snagglegon>(y, this);
+			m_nAliensOnScreen++;
+			m_waveCursor++;
+		} while (m_waveCursor < m_levelInfo.nWaves && m_nAliensOnScreen < min(m_maxNOfAliens, m_nOfAliensLeft));
+		return;
+	}
 	// if we CAN introduce an alien, create a new one
 	int smallChance   = 60;
 	int smoreChance   = 20 + (getLevel() * 5);
 	int snaggleChance = 5 + (getLevel() * 10);
 	int totalChance = smallChance + smoreChance + snaggleChance;
-	int test = randInt(0, totalChance);
+	int test = m_spawnRng.nextInt(0, totalChance);
 	if (test < smallChance)	// chance for a smallgon
 	{
-		Actor* tempAlien = new Smallgon(randInt(0, VIEW_HEIGHT - 1), this);
-		m_allActors.push_back(tempAlien);
+		spawnActor<Smallgon>(m_spawnRng.nextInt(0, VIEW_HEIGHT - 1), this);
 	}
 	else if (test < smallChance + smoreChance)	// chance for a smoregon
 	{
-		Actor* tempAlien = new Smoregon(randInt(0, VIEW_HEIGHT - 1), this);
-		m_allActors.push_back(tempAlien);
+		spawnActor<Smoregon>(m_spawnRng.nextInt(0, VIEW_HEIGHT - 1), this);
 	}
 	else	// chance for a snagglegon
 	{
-		Actor* tempAlien = new Snagglegon(randInt(0, VIEW_HEIGHT - 1), this);
-		m_allActors.push_back(tempAlien);
+		spawnActor<Snagglegon>(m_spawnRng.nextInt(0, VIEW_HEIGHT - 1), this);
 	}
 	m_nAliensOnScreen++;
 }
 void StudentWorld::checkFriendlyProjectiles()
 {
-	for (unsigned int i = 0; i < m_allActors.size(); ++i)
-		if (isFriendlyProjectile(m_allActors[i]))
-			for (unsigned int j = 0; j < m_allActors.size(); ++j)
+	// friendly projectiles only ever hurt aliens, so bin the living aliens and test each projectile
+	// against nearby ones. Both scans walk the actor table's arrays in order; dead actors can't collide.
+	const ActorHotData& hot = m_actorTable.hot();
+	unsigned int nSlots = m_actorTable.size();
+	m_alienGrid.clear();
+	for (unsigned int slot = 0; slot < nSlots; ++slot)
+		if (hot.alive[slot] && hot.kind[slot] >= FIRST_ALIEN_KIND && hot.kind[slot] <= LAST_ALIEN_KIND)
+			m_alienGrid.add(slot, hot.x[slot], hot.y[slot], hot.radius[slot]);
+	m_alienGrid.build();
+
+	m_projectileSlots.clear();
+	for (unsigned int slot = 0; slot < nSlots; ++slot)
+		if (hot.alive[slot] && hot.kind[slot] >= FIRST_FRIENDLY_PROJECTILE_KIND && hot.kind[slot] < FIRST_ENEMY_PROJECTILE_KIND)
+			m_projectileSlots.push_back(slot);
+
+	// finding what overlaps only reads the table, so it's split between threads; chunk c
+	// always gets the same projectiles, and its results go in m_narrowphase[c]
+	unsigned int nProjectiles = m_projectileSlots.size();
+	unsigned int nChunks = (nProjectiles + PROJECTILES_PER_TASK - 1) / PROJECTILES_PER_TASK;
+	if (m_narrowphase.size() < nChunks)
+		m_narrowphase.resize(nChunks);
+	m_threadPool->parallelFor(nProjectiles, PROJECTILES_PER_TASK, [this, &hot](unsigned int begin, unsigned int end, unsigned int c)
+	{
+		NarrowphaseChunk& chunk = m_narrowphase[c];
+		chunk.overlapping.clear();
+		chunk.tested = 0;
+		for (unsigned int p = begin; p < end; ++p)
+		{
+			unsigned int slot = m_projectileSlots[p];
+			m_alienGrid.query(hot.x[slot], hot.y[slot], hot.radius[slot], chunk.candidates);
+
+			// line the nearby aliens up in a block and test them all at once
+			unsigned int n = chunk.candidates.size();
+			chunk.x.resize(n);
+			chunk.y.resize(n);
+			chunk.radius.resize(n);
+			chunk.hits.resize(n);
+			for (unsigned int j = 0; j < n; ++j)
 			{
-				if (!m_allActors[i]->isAlive())
-					break;
-				m_allActors[i]->collide(*(m_allActors[j]));
+				chunk.x[j] = hot.x[chunk.candidates[j]];
+				chunk.y[j] = hot.y[chunk.candidates[j]];
+				chunk.radius[j] = hot.radius[chunk.candidates[j]];
 			}
+			chunk.tested += n;
+			unsigned int nHits = findOverlaps(hot.x[slot], hot.y[slot], hot.radius[slot],
+											  chunk.x.data(), chunk.y.data(), chunk.radius.data(), n, chunk.hits.data());
+			for (unsigned int h = 0; h < nHits; ++h)
+				chunk.overlapping.push_back(make_pair(slot, static_cast<unsigned int>(chunk.candidates[chunk.hits[h]])));
+		}
+	});
+
+	// acting on the hits changes the world, so that happens here, in projectile order
+	for (unsigned int c = 0; c < nChunks; ++c)
+	{
+		NarrowphaseChunk& chunk = m_narrowphase[c];
+		m_collisionStats.testedPairs += chunk.tested;
+		for (const pair<unsigned int, unsigned int>& hit : chunk.overlapping)
+			if (hot.alive[hit.first])	// a projectile stops at the first thing it hits
+				hot.actor[hit.first]->collideOverlapping(*(hot.actor[hit.second]));
+	}
+}
+void StudentWorld::moveFriendlyProjectiles()
+{
+	for (int kind = FIRST_FRIENDLY_PROJECTILE_KIND; kind < FIRST_ENEMY_PROJECTILE_KIND; ++kind)
+	{
+		const vector<Actor*>& actors = m_actors[kind];
+		m_threadPool->parallelFor(actors.size(), PROJECTILES_PER_TASK, [&actors](unsigned int begin, unsigned int end, unsigned int)
+		{
+			for (unsigned int i = begin; i < end; ++i)
+				actors[i]->doSomething();
+		});
+	}
+}
+void StudentWorld::updateEffects(void* world, unsigned int, unsigned int, unsigned int)
+{
+	StudentWorld* sw = static_cast<StudentWorld*>(world);
+	sw->m_starfield.update(sw->m_cosmeticRng);	// scroll the stars, maybe adding one
+	sw->m_particles.update();	// explosion particles can't hit anything
+}
+void StudentWorld::updateKinds(int firstKind, int endKind, bool hitsUser)
+{
+	for (int kind = firstKind; kind < endKind; ++kind)
+	{
+		vector<Actor*>& actors = m_actors[kind];
+		for (unsigned int i = 0; i < actors.size(); ++i)
+		{
+			if (hitsUser)
+				collideWithUser(*(actors[i]));		// see if user hits anything before and after moving
+			actors[i]->doSomething();
+			if (hitsUser)
+				collideWithUser(*(actors[i]));
+		}
+	}
+}
+void StudentWorld::collideWithUser(Actor& other)
+{
+	const ActorHotData& hot = m_actorTable.hot();
+	unsigned int user = m_user->getHandle().index, them = other.getHandle().index;
+	CellRange nearUser = SpatialGrid::cellsAround(hot.x[user], hot.y[user], collisionReach(hot.radius[user], hot.radius[them]));
+	if (!nearUser.contains(SpatialGrid::colOf(hot.x[them]), SpatialGrid::rowOf(hot.y[them])))
+		return;
+	m_collisionStats.testedPairs++;
+	m_user->collide(other);
+}
+void StudentWorld::countBruteForcePairs()
+{
+	// what the old all-pairs scans would have tested this tick: every friendly projectile against
+	// every actor (twice), and the user against every actor before and after it moves
+	unsigned long long nActors = 0, nFriendly = 0;
+	for (int kind = 0; kind < NUM_ACTOR_KINDS; ++kind)
+		nActors += m_actors[kind].size();
+	for (int kind = FIRST_FRIENDLY_PROJECTILE_KIND; kind < FIRST_ENEMY_PROJECTILE_KIND; ++kind)
+		nFriendly += m_actors[kind].size();
+	m_collisionStats.bruteForcePairs += 2 * nFriendly * nActors + 2 * nActors;
+}
+ActorTable& StudentWorld::getActorTable()
+{
+	return m_actorTable;
+}
+const CollisionStats& StudentWorld::getCollisionStats() const
+{
+	return m_collisionStats;
 }
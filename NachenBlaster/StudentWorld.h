@@ -3,38 +3,242 @@
 
 #include "GameWorld.h"
 #include "Actor.h"
+#include "ActorHandle.h"
+#include "ActorKind.h"
+#include "SpatialGrid.h"
+#include "Random.h"
+#include "ObjectPool.h"
+#include "Starfield.h"
+#include "ParticleSystem.h"
+#include "ThreadPool.h"
+#include "WorldSnapshot.h"
+#include "Replay.h"
+#include "RewindBuffer.h"
+#include "LevelSchedule.h"
+#include "EventQueue.h"
+#include "HudModel.h"
+#include "InputSource.h"
+#include "PlayerAction.h"
 #include <string>
 #include <vector>
 #include <sstream>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+  // Counts of actor pairs looked at by the collision passes
+
+struct CollisionStats
+{
+	unsigned long long bruteForcePairs;	// collide() calls the old all-pairs scans would have made
+	unsigned long long testedPairs;		// collide() calls actually made after the broadphase
+};
+
+  // One chunk of checkFriendlyProjectiles' parallel search: its scratch space,
+  // and the (projectile slot, alien slot) pairs it found overlapping, in order
+
+struct NarrowphaseChunk
+{
+	std::vector<int> candidates;
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> radius;
+	std::vector<unsigned int> hits;
+	std::vector<std::pair<unsigned int, unsigned int>> overlapping;
+	unsigned long long tested;
+};
 
 class Actor;
 class NachenBlaster;
+class Cabbage;
+class Turnip;
+class FTorpedoProjectile;
+class Repair;
+class ExtraLife;
+class FTorpedoGoodie;
+class Smallgon;
+class Smoregon;
+class Snagglegon;
+
 class StudentWorld : public GameWorld
 {
 public:
-    StudentWorld(std::string assetDir);
+    StudentWorld(std::string assetDir, std::uint64_t seed);	// the same seed and keys play the same game
 	~StudentWorld();
+	void reset(std::uint64_t seed);	// back to how the constructor left it, for a new game with seed; keeps its memory
     virtual int init();
     virtual int move();
     virtual void cleanUp();
+	virtual void getBackground(std::vector<SpriteBatch>& batches) const;	// the starfield
+	virtual void getForeground(std::vector<SpriteBatch>& batches) const;	// explosions
+
+	// random streams: alien spawning, actor behaviour, and things that don't affect gameplay
+	std::uint64_t getSeed() const;
+	Rng& getSpawnRng();
+	Rng& getAIRng();
+	Rng& getCosmeticRng();
+
+	// parts of each tick that don't depend on each other run on this pool; nullptr runs everything
+	// on the calling thread. The game plays out the same whatever the pool's size.
+	void setThreadPool(ThreadPool* pool);
+
+	// the whole world between two ticks: lives/score/level, every actor, the background, and the
+	// random streams. Loading puts the world back exactly, so it plays on the same way from there.
+	// If the snapshot is corrupt or from another version, loading returns false and changes nothing.
+	void saveSnapshot(WorldSnapshot& out) const;
+	bool loadSnapshot(const WorldSnapshot& in);
+	virtual bool quickSave(const std::string& path) const;
+	virtual bool quickLoad(const std::string& path);	// refused while recording or playing back a replay
+
+	// the same, split up by actor for the rewind buffer
+	void saveFrame(WorldFrame& out) const;
+	bool loadFrame(const WorldFrame& in);
+
+	// every tick starts by saving a frame into a RewindBuffer, within a memory budget (0 turns it off).
+	// Rewinding puts the world back as it was just before an earlier tick still in the buffer and
+	// forgets the ticks after it; refused while recording a replay.
+	virtual bool rewind(unsigned int ticks);	// as far back as it can go, up to ticks
+	bool rewindTo(unsigned long tick);
+	void setRewindBudget(std::size_t bytes);
+	const RewindBuffer& getRewindBuffer() const;
+
+	// the world's own clock: ticks played since the game began, across lives and levels
+	unsigned long getTick() const;
+
+	// a hash of the world as the last move() left it: each actor's kind, position (to 1/256 pixel),
+	// health and alive flag, taken in no particular order; the user's cabbage energy and torpedoes;
+	// lives, score, level, the alien counts and where the level schedule is up to; and the spawn and
+	// AI random streams. Two runs whose hashes match tick for tick played the same game. The run
+	// hash chains every tick's together.
+	std::uint64_t getStateHash() const;
+	std::uint64_t getRunHash() const;
+
+	// play the levels in a compiled schedule (nullptr: roll them as the game goes), from the next
+	// init() on. init() fails with GWSTATUS_LEVEL_ERROR if the schedule isn't open, and returns
+	// GWSTATUS_PLAYER_WON once the last level in it is finished. The schedule must outlive the world.
+	void setLevels(const LevelSchedule* levels);
+
+	// where the user's actions come from (nullptr: the host's keys, as KeyboardInput). The source
+	// must outlive the world, and isn't part of snapshots: replays record the actions it gave.
+	void setInput(InputSource* input);
+
+	// the user's action for this tick, from the replay being played back or else the input source;
+	// false if it does nothing. Quitting asks the host to quit; recording keeps the rest.
+	bool getAction(PlayerAction& action);
+
+	// record the seed and every action the user takes, with a keyframe every REPLAY_KEYFRAME_INTERVAL
+	// ticks, into replay (nullptr stops recording); or play replay back, taking the user's actions from
+	// it instead of the input source. With a startTick, the next init() jumps to the replay's last keyframe
+	// at or before it, rather than starting the level afresh. The world must have the replay's seed.
+	void setRecording(Replay* replay);
+	void setPlayback(Replay* replay, unsigned long startTick = 0);
 
 	// helper functions
 	NachenBlaster* getUser() const;	// returns the user
-	void createInitialStars();	// creates stars for initialization
-	void displayStatusLine();	// creates and displays the status line
+	Actor* getActor(ActorHandle handle) const;	// returns the actor, or nullptr if it has been removed
+	ActorTable& getActorTable();	// every actor registers itself here when it's constructed
+	void displayStatusLine();	// updates the status line, if anything on it changed
 	void decrAliensLeft();	// decrease nOfAliens left to kill
-	void createActor(Actor* newActor);	// adds a new actor to actor vector
-	void removeDeadActors();	// removes any dead actors from the vector
-	void possiblyCreateStar();	// chance of adding a new star
-	void possiblyCreateAlien();	// adds a randomly selected alien if there's space for it
+	EventQueue& getEvents();	// sounds, score, lives and torpedoes: applied together at the end of the tick
+	void createActor(Actor* newActor);	// queues a new actor to join its kind's vector at the next addPendingActors
+
+	// builds a T in this world's pool for T and queues it with createActor
+	template<typename T, typename... Args>
+	T* spawnActor(Args&&... args)
+	{
+		T* actor = spawnInPool<T>(std::forward<Args>(args)...);
+		createActor(actor);
+		return actor;
+	}
+	std::vector<PoolStats> getPoolStats() const;	// one entry per actor pool
+
+	void addPendingActors();	// moves everything created this tick into the actor vectors
+	void removeDeadActors();	// removes any dead actors from the vectors
+	void possiblyCreateAlien();	// adds the next scheduled aliens, or else a randomly selected one, if there's space
 	void checkFriendlyProjectiles();  // checks if friendly projectiles hit any aliens
+	void collideWithUser(Actor& other);	// checks if the user hits other, skipping anything far away
+	const CollisionStats& getCollisionStats() const;
+
+	// calls f(actor) on every actor except the user, kind by kind
+	template<typename Func>
+	void forEachActor(Func f) const
+	{
+		for (int kind = 0; kind < NUM_ACTOR_KINDS; ++kind)
+			for (Actor* actor : m_actors[kind])
+				f(actor);
+	}
 
 private:
+	void destroyActor(Actor* actor);	// frees the actor's handle and returns it to its pool
+	Actor* createActorOfKind(int kind);	// a default one from the kind's pool, for loading snapshots
+	bool restoreSnapshot(const WorldSnapshot& in);	// loadSnapshot without the undo
+	template<typename WriteState>
+	void saveWorld(SnapshotWriter& w, SnapshotWriter& effects, WriteState writeState) const;
+	template<typename ReadState>
+	bool restoreWorld(SnapshotReader& r, SnapshotReader& effects, ReadState readState);
+	template<typename Restore>
+	bool restoreWithUndo(Restore restore);	// puts the world back as it was if restore() fails
+
+	template<typename T, typename... Args>
+	T* spawnInPool(Args&&... args)
+	{
+		return std::get<ObjectPool<T>>(m_pools).create(std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	void releaseActor(T* actor)
+	{
+		std::get<ObjectPool<T>>(m_pools).destroy(actor);
+	}
+
+	std::uint64_t hashState() const;
+	void applyEvents();	// plays and applies what's in m_events, then empties it
+	void countBruteForcePairs();	// adds this tick's all-pairs count to m_collisionStats
+	void updateKinds(int firstKind, int endKind, bool hitsUser);	// runs doSomething on kinds [firstKind, endKind)
+	void moveFriendlyProjectiles();	// in parallel: each one only moves itself
+	static void updateEffects(void* world, unsigned int, unsigned int, unsigned int);	// stars and particles
+
+	std::uint64_t m_seed;
+	unsigned long m_tickCount;	// calls to move() so far this game
+	std::uint64_t m_stateHash;
+	std::uint64_t m_runHash;
+	Replay* m_recording;
+	Replay* m_playback;
+	unsigned long m_playbackStart;	// tick for the next init() to jump to, or 0
+	InputSource* m_input;	// never nullptr: &m_keyboard by default
+	KeyboardInput m_keyboard;
+	ReplayInput m_replayInput;	// m_playback's actions
+	Rng m_spawnRng;
+	Rng m_aiRng;
+	Rng m_cosmeticRng;
 	int m_nAliensOnScreen;	// number of aliens on screen
 	int m_maxNOfAliens;		// max aliens on screen for given level
 	int m_nOfAliensLeft;	// number of aliens left until level is over
-	std::vector<Actor*> m_allActors;
+	const LevelSchedule* m_levels;	// nullptr: aliens are rolled at random
+	LevelInfo m_levelInfo;	// this level's entry in m_levels (no waves without one)
+	unsigned long m_levelTick;	// calls to move() since this level (or life) began
+	std::uint32_t m_waveCursor;	// this level's next wave to spawn
+	std::vector<Actor*> m_actors[NUM_ACTOR_KINDS];	// one vector per concrete kind (the user isn't in any)
+	std::vector<Actor*> m_pendingActors;	// created this tick, not yet in m_actors
+	ActorTable m_actorTable;	// handles and hot data for every actor, including the user and pending ones
 	NachenBlaster* m_user;
+	Starfield m_starfield;
+	ParticleSystem m_particles;
+	EventQueue m_events;	// this tick's side effects, not yet applied
+	HudModel m_hud;	// the status line as last sent to the controller
+	SpatialGrid m_alienGrid;	// actor table slots of living aliens, binned by cell for checkFriendlyProjectiles
+	std::vector<unsigned int> m_projectileSlots;	// living friendly projectiles, in table order
+	std::vector<NarrowphaseChunk> m_narrowphase;	// one per parallelFor chunk of m_projectileSlots
+	ThreadPool m_inlinePool;	// no threads: used when nobody has set a pool
+	ThreadPool* m_threadPool;
+	RewindBuffer m_rewind;
+	WorldFrame m_rewindFrame;	// scratch space for rewindTo
+	WorldSnapshot m_undoSnapshot;	// the world as it was before a loadSnapshot, in case that fails
+	CollisionStats m_collisionStats;
+	// actors are recycled through these rather than new/delete; they live as long as the world
+	std::tuple<ObjectPool<Cabbage>, ObjectPool<Turnip>,
+			   ObjectPool<FTorpedoProjectile>, ObjectPool<Repair>, ObjectPool<ExtraLife>, ObjectPool<FTorpedoGoodie>,
+			   ObjectPool<Smallgon>, ObjectPool<Smoregon>, ObjectPool<Snagglegon>> m_pools;
 };
 
 #endif // STUDENTWORLD_H_
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// which pool's worker this thread is, if any, and which queue is its own
+static thread_local const ThreadPool* t_pool = nullptr;
+static thread_local unsigned int t_queue = 0;
+
+ThreadPool::ThreadPool(unsigned int nThreads)
+	: m_queues(nThreads == 0 ? 1 : nThreads), m_queued(0), m_stopping(false)
+{
+	for (WorkQueue& q : m_queues)
+	{
+		q.front = 0;
+		q.back = 0;
+	}
+	for (unsigned int i = 1; i < m_queues.size(); i++)
+		m_workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(m_sleepMutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	for (thread& t : m_workers)
+		t.join();
+}
+
+unsigned int ThreadPool::getThreadCount() const
+{
+	return m_queues.size();
+}
+
+void ThreadPool::submit(TaskGroup& group, TaskFunc run, void* context, unsigned int begin, unsigned int end, unsigned int chunk)
+{
+	Task task = { run, context, begin, end, chunk, &group };
+	group.m_pending.fetch_add(1, memory_order_relaxed);
+	if (m_workers.empty())	// nobody else to run it
+	{
+		execute(task);
+		return;
+	}
+
+	WorkQueue& q = m_queues[currentQueue()];
+	{
+		lock_guard<mutex> lock(q.mutex);
+		if (q.back - q.front < QUEUE_CAPACITY)
+		{
+			q.tasks[q.back++ & (QUEUE_CAPACITY - 1)] = task;
+			task.run = nullptr;	// queued
+		}
+	}
+	if (task.run != nullptr)	// queue was full
+	{
+		execute(task);
+		return;
+	}
+
+	m_queued.fetch_add(1, memory_order_release);
+	{
+		lock_guard<mutex> lock(m_sleepMutex);	// so a worker can't miss this between checking m_queued and sleeping
+	}
+	m_wake.notify_one();
+}
+
+void ThreadPool::wait(TaskGroup& group)
+{
+	unsigned int queue = currentQueue();
+	while (!group.done())
+	{
+		if (!runOne(queue))
+			this_thread::yield();	// the rest of the group is running on other threads
+	}
+}
+
+unsigned int ThreadPool::currentQueue() const
+{
+	return (t_pool == this ? t_queue : 0);
+}
+
+bool ThreadPool::runOne(unsigned int queue)
+{
+	Task task;
+	bool found = false;
+	{
+		WorkQueue& q = m_queues[queue];
+		lock_guard<mutex> lock(q.mutex);
+		if (q.back != q.front)
+		{
+			task = q.tasks[--q.back & (QUEUE_CAPACITY - 1)];	// newest first: it's likeliest to be in cache
+			found = true;
+		}
+	}
+	for (unsigned int i = 1; !found && i < m_queues.size(); i++)
+	{
+		WorkQueue& victim = m_queues[(queue + i) % m_queues.size()];
+		lock_guard<mutex> lock(victim.mutex);
+		if (victim.back != victim.front)
+		{
+			task = victim.tasks[victim.front++ & (QUEUE_CAPACITY - 1)];	// oldest first: probably the biggest piece left
+			found = true;
+		}
+	}
+	if (!found)
+		return false;
+	m_queued.fetch_sub(1, memory_order_relaxed);
+	execute(task);
+	return true;
+}
+
+void ThreadPool::execute(const Task& task)
+{
+	task.run(task.context, task.begin, task.end, task.chunk);
+	task.group->m_pending.fetch_sub(1, memory_order_release);
+}
+
+void ThreadPool::workerLoop(unsigned int queue)
+{
+	t_pool = this;
+	t_queue = queue;
+	for (;;)
+	{
+		if (runOne(queue))
+			continue;
+		unique_lock<mutex> lock(m_sleepMutex);
+		m_wake.wait(lock, [this]() { return m_stopping || m_queued.load(memory_order_acquire) > 0; });
+		if (m_stopping)
+			return;
+	}
+}
@@ -0,0 +1,139 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+  // Tasks submitted together, so they can be waited for together.
+  // A group must outlive the wait for it.
+
+class TaskGroup
+{
+public:
+	TaskGroup()
+		: m_pending(0)
+	{
+	}
+
+	bool done() const
+	{
+		return m_pending.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	friend class ThreadPool;
+	std::atomic<unsigned int> m_pending;
+
+	// Prevent copying or assigning TaskGroups
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+};
+
+  // Fixed set of worker threads with one task queue each. A thread runs the
+  // newest task in its own queue and, when that's empty, steals the oldest
+  // from someone else's. The thread that owns the pool (the one calling
+  // submit and wait) counts as one of the threads: it runs tasks while it
+  // waits, and a pool of 1 thread has no workers and runs everything inline.
+  // Submitting and running tasks never allocates.
+  //
+  //     TaskGroup background;
+  //     pool.submit(background, scrollStars);	// runs while the caller carries on
+  //     pool.parallelFor(n, 8, moveSome);		// returns when every chunk is done
+  //     pool.wait(background);
+
+class ThreadPool
+{
+public:
+	using TaskFunc = void (*)(void* context, unsigned int begin, unsigned int end, unsigned int chunk);
+
+	explicit ThreadPool(unsigned int nThreads = 1);	// counting the owning thread
+	~ThreadPool();
+
+	unsigned int getThreadCount() const;
+
+	  // Queues run(context, begin, end, chunk) to run on any thread.
+	  // context must stay valid until the group has been waited for.
+	void submit(TaskGroup& group, TaskFunc run, void* context,
+				unsigned int begin = 0, unsigned int end = 0, unsigned int chunk = 0);
+
+	template<typename Func>
+	void submit(TaskGroup& group, Func& f)	// f()
+	{
+		submit(group, &callTask<Func>, &f);
+	}
+
+	  // Runs queued tasks until every task in group has finished
+	void wait(TaskGroup& group);
+
+	  // Splits [0, count) into chunks of grain items and calls f(begin, end, chunk)
+	  // for each, in parallel. Chunk c always covers the same items, whatever the
+	  // thread count, so per-chunk results can be merged in chunk order.
+	template<typename Func>
+	void parallelFor(unsigned int count, unsigned int grain, const Func& f)
+	{
+		if (grain == 0)
+			grain = 1;
+		TaskGroup group;
+		unsigned int chunk = 0;
+		for (unsigned int begin = 0; begin < count; begin += grain, chunk++)
+		{
+			unsigned int end = (count - begin > grain ? begin + grain : count);
+			submit(group, &callRange<Func>, const_cast<void*>(static_cast<const void*>(&f)), begin, end, chunk);
+		}
+		wait(group);
+	}
+
+private:
+	struct Task
+	{
+		TaskFunc		run;
+		void*			context;
+		unsigned int	begin;
+		unsigned int	end;
+		unsigned int	chunk;
+		TaskGroup*		group;
+	};
+
+	static const unsigned int QUEUE_CAPACITY = 256;	// power of 2; a full queue runs new tasks inline
+
+	struct WorkQueue	// ring buffer; the owner pushes and pops at the back, thieves take from the front
+	{
+		std::mutex		mutex;
+		Task			tasks[QUEUE_CAPACITY];
+		unsigned int	front;
+		unsigned int	back;
+	};
+
+	template<typename Func>
+	static void callTask(void* context, unsigned int, unsigned int, unsigned int)
+	{
+		(*static_cast<Func*>(context))();
+	}
+
+	template<typename Func>
+	static void callRange(void* context, unsigned int begin, unsigned int end, unsigned int chunk)
+	{
+		(*static_cast<const Func*>(context))(begin, end, chunk);
+	}
+
+	unsigned int currentQueue() const;	// this thread's queue; the owning thread uses queue 0
+	bool runOne(unsigned int queue);	// runs one task from queue, or stolen from another; false if there were none
+	void execute(const Task& task);
+	void workerLoop(unsigned int queue);
+
+	std::vector<WorkQueue>		m_queues;
+	std::vector<std::thread>	m_workers;
+	std::atomic<unsigned int>	m_queued;	// tasks sitting in queues, not yet started
+	std::mutex					m_sleepMutex;
+	std::condition_variable		m_wake;
+	bool						m_stopping;
+
+	// Prevent copying or assigning ThreadPools
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif // THREADPOOL_H_
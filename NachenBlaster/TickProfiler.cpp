@@ -0,0 +1,73 @@
+#include "TickProfiler.h"
+#include <vector>
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+using namespace std;
+
+TickProfiler::TickProfiler()
+#ifdef NB_PROFILE
+	: m_samples(NUM_PROFILE_PHASES * SAMPLES_PER_PHASE)
+#endif
+{
+	reset();
+}
+
+void TickProfiler::reset()
+{
+	for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+		m_count[phase].store(0, memory_order_relaxed);
+}
+
+void TickProfiler::report(ostream& out) const
+{
+	out << left << setw(22) << "phase" << right << setw(10) << "samples"
+		<< setw(12) << "p50 us" << setw(12) << "p99 us" << setw(12) << "max us" << endl;
+
+	vector<uint32_t> samples;
+	samples.reserve(SAMPLES_PER_PHASE);
+	bool anySamples = false;
+	for (int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+	{
+		unsigned int count = m_count[phase].load(memory_order_acquire);
+		unsigned int n = (count < SAMPLES_PER_PHASE ? count : SAMPLES_PER_PHASE);
+		if (n == 0)
+			continue;
+		anySamples = true;
+		samples.assign(m_samples.begin() + phase * SAMPLES_PER_PHASE, m_samples.begin() + phase * SAMPLES_PER_PHASE + n);
+
+		// percentile k is the sample with k% of the others below it
+		auto percentile = [&](int k)
+		{
+			vector<uint32_t>::iterator p = samples.begin() + (n - 1) * k / 100;
+			nth_element(samples.begin(), p, samples.end());
+			return *p / 1000.0;
+		};
+		double p50 = percentile(50);
+		double p99 = percentile(99);
+		double worst = *max_element(samples.begin(), samples.end()) / 1000.0;
+
+		out << left << setw(22) << phaseName(static_cast<ProfilePhase>(phase)) << right << setw(10) << count
+			<< fixed << setprecision(2) << setw(12) << p50 << setw(12) << p99 << setw(12) << worst << endl;
+	}
+	out.unsetf(ios::floatfield);
+	if (!anySamples)
+		out << "no samples (build with NB_PROFILE defined to record them)" << endl;
+}
+
+const char* TickProfiler::phaseName(ProfilePhase phase)
+{
+	switch (phase)
+	{
+	case PHASE_TICK:				return "move";
+	case PHASE_STATUS_LINE:			return "status line";
+	case PHASE_SPAWN:				return "spawn";
+	case PHASE_PROJECTILES_BEFORE:	return "projectiles (before)";
+	case PHASE_ACTORS:				return "actors";
+	case PHASE_PROJECTILES_AFTER:	return "projectiles (after)";
+	case PHASE_REMOVE_DEAD:			return "remove dead";
+	case PHASE_EVENTS:				return "events";
+	case PHASE_DISPLAY:				return "display";
+	default:						return "?";
+	}
+}
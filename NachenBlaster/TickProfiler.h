@@ -0,0 +1,97 @@
+#ifndef TICKPROFILER_H_
+#define TICKPROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+  // Per-phase timing of StudentWorld::move() and GameController::displayGamePlay().
+  // Build with NB_PROFILE defined (e.g. /D NB_PROFILE) to turn it on; otherwise
+  // PROFILE_PHASE expands to nothing and no timing code is compiled in. Each
+  // world records into the profiler its driver gave it (GameWorld::getProfiler).
+  //
+  //     {
+  //         PROFILE_PHASE(getProfiler(), PHASE_REMOVE_DEAD);
+  //         removeDeadActors();
+  //     }
+
+enum ProfilePhase
+{
+	PHASE_TICK,				// all of StudentWorld::move()
+	PHASE_STATUS_LINE,
+	PHASE_SPAWN,			// possiblyCreateAlien
+	PHASE_PROJECTILES_BEFORE,	// first checkFriendlyProjectiles
+	PHASE_ACTORS,			// user and actor doSomething, with user collisions
+	PHASE_PROJECTILES_AFTER,	// second checkFriendlyProjectiles
+	PHASE_REMOVE_DEAD,
+	PHASE_EVENTS,			// applying the tick's queued sounds, score, lives and torpedoes
+	PHASE_DISPLAY,			// GameController::displayGamePlay
+	NUM_PROFILE_PHASES
+};
+
+class TickProfiler
+{
+public:
+	static const unsigned int SAMPLES_PER_PHASE = 4096;	// power of 2; older samples are overwritten
+
+	TickProfiler();
+
+	  // Lock-free: one thread records while another may be reporting. A report
+	  // taken mid-write may see a stale sample, never a torn index.
+	void record(ProfilePhase phase, std::uint32_t nanoseconds)
+	{
+		unsigned int n = m_count[phase].load(std::memory_order_relaxed);
+		m_samples[phase * SAMPLES_PER_PHASE + (n & (SAMPLES_PER_PHASE - 1))] = nanoseconds;
+		m_count[phase].store(n + 1, std::memory_order_release);
+	}
+
+	void report(std::ostream& out) const;	// p50/p99/max of the recent samples of each phase
+	void reset();
+
+	static const char* phaseName(ProfilePhase phase);
+
+private:
+	std::vector<std::uint32_t> m_samples;	// SAMPLES_PER_PHASE per phase; only allocated in NB_PROFILE builds
+	std::atomic<unsigned int> m_count[NUM_PROFILE_PHASES];
+
+	// Prevent copying or assigning TickProfilers
+	TickProfiler(const TickProfiler&) = delete;
+	TickProfiler& operator=(const TickProfiler&) = delete;
+};
+
+  // Times from construction to the end of the enclosing scope, into profiler (if there is one)
+class ScopedPhaseTimer
+{
+public:
+	ScopedPhaseTimer(TickProfiler* profiler, ProfilePhase phase)
+		: m_profiler(profiler), m_phase(phase), m_start(std::chrono::steady_clock::now())
+	{
+	}
+
+	~ScopedPhaseTimer()
+	{
+		if (m_profiler == nullptr)
+			return;
+		std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - m_start;
+		m_profiler->record(m_phase, static_cast<std::uint32_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+	}
+
+private:
+	TickProfiler* m_profiler;
+	ProfilePhase m_phase;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#ifdef NB_PROFILE
+#define PROFILE_PHASE(profiler, phase) ScopedPhaseTimer PROFILE_CONCAT(phaseTimer_, __LINE__)(profiler, phase)
+#else
+#define PROFILE_PHASE(profiler, phase) ((void)0)
+#endif
+
+#endif // TICKPROFILER_H_
@@ -0,0 +1,242 @@
+#include "VecEnv.h"
+#include "StudentWorld.h"
+#include "Actor.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+using namespace std;
+
+VecEnv::VecEnv(string assetDir, unsigned int nWorlds, unsigned int nThreads)
+	: m_pool(nThreads > 0 ? nThreads : 1), m_maxEpisodeTicks(0), m_levels(nullptr)
+{
+	for (unsigned int i = 0; i < nWorlds; i++)
+	{
+		m_slots.push_back(make_unique<Slot>());
+		Slot& slot = *m_slots.back();
+		slot.world = make_unique<StudentWorld>(assetDir, i);
+		slot.world->setController(&slot);
+		slot.world->setInput(&slot);
+		slot.world->setRewindBudget(0);	// an agent can't rewind, so don't pay for it
+		slot.seed = i;
+		slot.ticks = 0;
+		slot.lastScore = 0;
+		slot.action = 0;
+		slot.over = true;
+	}
+}
+
+VecEnv::~VecEnv()
+{
+}
+
+void VecEnv::setMaxEpisodeTicks(unsigned long ticks)
+{
+	m_maxEpisodeTicks = ticks;
+}
+
+void VecEnv::setLevels(const LevelSchedule* levels)
+{
+	m_levels = levels;
+}
+
+unsigned int VecEnv::size() const
+{
+	return static_cast<unsigned int>(m_slots.size());
+}
+
+const StudentWorld& VecEnv::getWorld(unsigned int i) const
+{
+	return *m_slots[i]->world;
+}
+
+void VecEnv::reset(const uint64_t* seeds, NBObservation* observations)
+{
+	m_pool.parallelFor(size(), 1, [&](unsigned int begin, unsigned int, unsigned int)
+	{
+		Slot& slot = *m_slots[begin];
+		startGame(slot, seeds[begin]);
+		if (observations != nullptr)
+			observe(slot, observations[begin]);
+	});
+}
+
+// each world only touches its own slot and its own entries of the outputs
+void VecEnv::step(const int* actions, NBObservation* observations, float* rewards, uint8_t* dones)
+{
+	m_pool.parallelFor(size(), 1, [&](unsigned int begin, unsigned int, unsigned int)
+	{
+		Slot& slot = *m_slots[begin];
+		float reward = 0;
+		bool done = stepWorld(slot, actions[begin], reward);
+		if (done)
+			startGame(slot, slot.seed + size());
+		if (observations != nullptr)
+			observe(slot, observations[begin]);
+		if (rewards != nullptr)
+			rewards[begin] = reward;
+		if (dones != nullptr)
+			dones[begin] = done;
+	});
+}
+
+void VecEnv::startGame(Slot& slot, uint64_t seed)
+{
+	slot.world->reset(seed);
+	slot.world->setLevels(m_levels);
+	slot.seed = seed;
+	slot.ticks = 0;
+	slot.lastScore = 0;
+	slot.action = 0;
+	int status = slot.world->init();
+	slot.over = (status != GWSTATUS_CONTINUE_GAME);
+}
+
+// one tick, with the level progression of GameController::doSomething (and HeadlessDriver::playUntil)
+bool VecEnv::stepWorld(Slot& slot, int action, float& reward)
+{
+	if (slot.over)	// init() had nothing to play
+		return true;
+	slot.action = static_cast<uint32_t>(action) & PlayerAction::ALL;
+	StudentWorld& world = *slot.world;
+	int status = world.move();
+	slot.ticks++;
+	bool done = false;
+	if (status == GWSTATUS_PLAYER_DIED)
+	{
+		world.cleanUp();
+		done = world.isGameOver() || world.init() != GWSTATUS_CONTINUE_GAME;
+	}
+	else if (status == GWSTATUS_FINISHED_LEVEL)
+	{
+		world.advanceToNextLevel();
+		world.cleanUp();
+		done = (world.init() != GWSTATUS_CONTINUE_GAME);	// won the last level, or a level error
+	}
+	else if (status != GWSTATUS_CONTINUE_GAME)
+		done = true;
+	reward = static_cast<float>(world.getScore()) - static_cast<float>(slot.lastScore);
+	slot.lastScore = world.getScore();
+	return done || (m_maxEpisodeTicks > 0 && slot.ticks >= m_maxEpisodeTicks);
+}
+
+void VecEnv::observe(const Slot& slot, NBObservation& out)
+{
+	const StudentWorld& world = *slot.world;
+	const NachenBlaster* user = world.getUser();
+	out.x = (user != nullptr ? static_cast<float>(user->getX()) : 0);
+	out.y = (user != nullptr ? static_cast<float>(user->getY()) : 0);
+	out.health = (user != nullptr ? static_cast<float>(user->getHealth()) : 0);
+	out.cabbageEnergy = (user != nullptr ? static_cast<float>(user->getCabbageEnergy()) : 0);
+	out.torpedoes = (user != nullptr ? static_cast<float>(user->getNOfTorpedoes()) : 0);
+	out.lives = static_cast<float>(world.getLives());
+	out.level = static_cast<float>(world.getLevel());
+	out.score = static_cast<float>(world.getScore());
+	out.ticks = static_cast<float>(slot.ticks);
+
+	unsigned int nAliens = 0, nProjectiles = 0, nGoodies = 0;
+	auto add = [](NBEntity* entities, unsigned int& count, unsigned int capacity, const Actor* actor)
+	{
+		if (count < capacity)
+		{
+			NBEntity& e = entities[count];
+			e.x = static_cast<float>(actor->getX());
+			e.y = static_cast<float>(actor->getY());
+			e.kind = static_cast<float>(actor->getKind());
+			e.health = static_cast<float>(actor->getHealth());
+		}
+		count++;
+	};
+	world.forEachActor([&](const Actor* actor)
+	{
+		if (isAlien(actor))
+			add(out.aliens, nAliens, NB_OBS_MAX_ALIENS, actor);
+		else if (isGoodie(actor))
+			add(out.goodies, nGoodies, NB_OBS_MAX_GOODIES, actor);
+		else
+			add(out.projectiles, nProjectiles, NB_OBS_MAX_PROJECTILES, actor);
+	});
+	out.nAliens = static_cast<float>(nAliens);
+	out.nProjectiles = static_cast<float>(nProjectiles);
+	out.nGoodies = static_cast<float>(nGoodies);
+
+	auto clearFrom = [](NBEntity* entities, unsigned int count, unsigned int capacity)
+	{
+		for (unsigned int i = count; i < capacity; i++)
+		{
+			entities[i].x = entities[i].y = entities[i].health = 0;
+			entities[i].kind = -1;
+		}
+	};
+	clearFrom(out.aliens, nAliens, NB_OBS_MAX_ALIENS);
+	clearFrom(out.projectiles, nProjectiles, NB_OBS_MAX_PROJECTILES);
+	clearFrom(out.goodies, nGoodies, NB_OBS_MAX_GOODIES);
+}
+
+bool VecEnv::Slot::nextAction(const StudentWorld& world, PlayerAction& out)
+{
+	if (action == 0)
+		return false;
+	out = PlayerAction::unpack(action);
+	action = 0;
+	return true;
+}
+
+bool VecEnv::Slot::getLastKey(int& value)	// nothing reads keys: the world takes actions from nextAction
+{
+	return false;
+}
+
+void VecEnv::Slot::playSound(int soundID)
+{
+}
+
+void VecEnv::Slot::setGameStatText(string_view text)
+{
+}
+
+void VecEnv::Slot::quitGame()
+{
+}
+
+///////////////////////////////////
+// C API
+///////////////////////////////////
+
+struct NBVecEnv : public VecEnv
+{
+	using VecEnv::VecEnv;
+};
+
+NBVecEnv* nb_env_create(const char* assetDir, unsigned int nWorlds, unsigned int nThreads)
+{
+	if (nWorlds == 0)
+		return nullptr;
+	return new NBVecEnv(assetDir != nullptr ? assetDir : "", nWorlds, nThreads);
+}
+
+void nb_env_destroy(NBVecEnv* env)
+{
+	delete env;
+}
+
+unsigned int nb_env_size(const NBVecEnv* env)
+{
+	return env->size();
+}
+
+void nb_env_set_max_episode_ticks(NBVecEnv* env, unsigned long ticks)
+{
+	env->setMaxEpisodeTicks(ticks);
+}
+
+void nb_env_reset(NBVecEnv* env, const uint64_t* seeds, NBObservation* observations)
+{
+	env->reset(seeds, observations);
+}
+
+void nb_env_step(NBVecEnv* env, const int* actions, NBObservation* observations, float* rewards, uint8_t* dones)
+{
+	env->step(actions, observations, rewards, dones);
+}
@@ -0,0 +1,150 @@
+#ifndef VECENV_H_
+#define VECENV_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+  // A batch of K worlds stepped in lockstep, for training agents. Each step takes
+  // one action per world and writes every world's observation, reward (the score it
+  // gained) and done flag into buffers the caller owns, so nothing is copied twice
+  // and nothing is allocated once the worlds have warmed up. A world whose game ends
+  // (game over, last level won, or the episode tick limit) starts its next game
+  // within the same step: its done flag is set and its observation is already the
+  // first of the new game. Its new seed is the old one plus K, so the worlds of a
+  // batch never play the same game.
+  //
+  // The C part of this header can be included from C; the C++ class is VecEnv.
+
+  // Actions: any combination of these bits (the same as PlayerAction::pack), so there
+  // are NB_NUM_ACTIONS of them, 0 to NB_NUM_ACTIONS - 1. Up and down together cancel
+  // out, as do left and right.
+enum NBAction
+{
+	NB_ACTION_NONE = 0,
+	NB_ACTION_UP = 1, NB_ACTION_DOWN = 2, NB_ACTION_LEFT = 4, NB_ACTION_RIGHT = 8,
+	NB_ACTION_FIRE = 16, NB_ACTION_TORPEDO = 32,
+	NB_NUM_ACTIONS = 64
+};
+
+#define NB_OBS_MAX_ALIENS		32
+#define NB_OBS_MAX_PROJECTILES	64
+#define NB_OBS_MAX_GOODIES		8
+
+  // One actor on screen: position in pixels, ActorKind, and health (aliens only).
+  // Unused entries have kind -1 and everything else 0.
+typedef struct NBEntity
+{
+	float x;
+	float y;
+	float kind;
+	float health;
+} NBEntity;
+
+  // Everything is a float, so a buffer of K observations can also be read as a
+  // K x (sizeof(NBObservation) / sizeof(float)) array. Counts beyond the fixed
+  // arrays are still counted, but only the first entries (in the world's own
+  // order, kind by kind) are filled in.
+typedef struct NBObservation
+{
+	float x;				// the ship; all 0 between games
+	float y;
+	float health;			// 0 to 50
+	float cabbageEnergy;	// 0 to 30
+	float torpedoes;
+	float lives;
+	float level;
+	float score;
+	float nAliens;
+	float nProjectiles;		// both sides' (their kinds tell them apart)
+	float nGoodies;
+	float ticks;			// ticks played this game
+	NBEntity aliens[NB_OBS_MAX_ALIENS];
+	NBEntity projectiles[NB_OBS_MAX_PROJECTILES];
+	NBEntity goodies[NB_OBS_MAX_GOODIES];
+} NBObservation;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct NBVecEnv NBVecEnv;
+
+  // nThreads worker threads (counting the caller) step the worlds; 1 steps them all
+  // on the calling thread. Returns NULL if nWorlds is 0.
+NBVecEnv* nb_env_create(const char* assetDir, unsigned int nWorlds, unsigned int nThreads);
+void nb_env_destroy(NBVecEnv* env);
+unsigned int nb_env_size(const NBVecEnv* env);
+void nb_env_set_max_episode_ticks(NBVecEnv* env, unsigned long ticks);	// 0: no limit (the default)
+
+  // seeds[K] in, observations[K] out: starts a new game in every world
+void nb_env_reset(NBVecEnv* env, const uint64_t* seeds, NBObservation* observations);
+
+  // actions[K] (NBAction) in; observations[K], rewards[K] and dones[K] out.
+  // Any of the outputs may be NULL if the caller doesn't want it.
+void nb_env_step(NBVecEnv* env, const int* actions, NBObservation* observations, float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+
+#include "GameWorld.h"
+#include "InputSource.h"
+#include "ThreadPool.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class StudentWorld;
+class LevelSchedule;
+
+class VecEnv
+{
+public:
+	VecEnv(std::string assetDir, unsigned int nWorlds, unsigned int nThreads = 1);
+	~VecEnv();
+
+	void setMaxEpisodeTicks(unsigned long ticks);	// 0: no limit
+	void setLevels(const LevelSchedule* levels);	// from the next game each world starts
+
+	unsigned int size() const;
+	const StudentWorld& getWorld(unsigned int i) const;
+
+	void reset(const std::uint64_t* seeds, NBObservation* observations);
+	void step(const int* actions, NBObservation* observations, float* rewards, std::uint8_t* dones);
+
+private:
+	  // One world of the batch, with the host and the input that hand it its action
+	struct Slot : public GameHost, public InputSource
+	{
+		std::unique_ptr<StudentWorld> world;
+		std::uint64_t	seed;
+		unsigned long	ticks;	// this game
+		unsigned int	lastScore;
+		std::uint32_t	action;	// this step's NBAction bits, or 0 once read
+		bool			over;	// between games (won or level error straight from init)
+
+		virtual bool nextAction(const StudentWorld& world, PlayerAction& out);
+		virtual bool getLastKey(int& value);
+		virtual void playSound(int soundID);
+		virtual void setGameStatText(std::string_view text);
+		virtual void quitGame();
+	};
+
+	std::vector<std::unique_ptr<Slot>> m_slots;
+	ThreadPool		m_pool;
+	unsigned long	m_maxEpisodeTicks;
+	const LevelSchedule* m_levels;
+
+	void startGame(Slot& slot, std::uint64_t seed);
+	bool stepWorld(Slot& slot, int action, float& reward);	// true if its game ended
+	static void observe(const Slot& slot, NBObservation& out);
+
+	// Prevent copying or assigning VecEnvs
+	VecEnv(const VecEnv&) = delete;
+	VecEnv& operator=(const VecEnv&) = delete;
+};
+
+#endif // __cplusplus
+
+#endif // VECENV_H_
@@ -0,0 +1,35 @@
+#include "WorldSnapshot.h"
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+bool WorldSnapshot::writeFile(const string& path) const
+{
+	ofstream out(path, ios::out | ios::binary | ios::trunc);
+	if (!out)
+		return false;
+	out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	return static_cast<bool>(out);
+}
+
+bool WorldSnapshot::readFile(const string& path)
+{
+	bytes.clear();
+	ifstream in(path, ios::in | ios::binary);
+	if (!in)
+		return false;
+	in.seekg(0, ios::end);
+	streamoff size = in.tellg();
+	if (size < 0)
+		return false;
+	in.seekg(0, ios::beg);
+	bytes.resize(static_cast<size_t>(size));
+	in.read(reinterpret_cast<char*>(bytes.data()), size);
+	if (!in)
+	{
+		bytes.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,144 @@
+#ifndef WORLDSNAPSHOT_H_
+#define WORLDSNAPSHOT_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+  // A StudentWorld frozen between two ticks (see StudentWorld::saveSnapshot).
+  // The bytes are the fields in a fixed order, in the machine's own byte order,
+  // after a magic number and a version; a snapshot from a different version is
+  // refused rather than misread. Keep one around and save into it again and
+  // again: once its buffer has grown to fit, saving never allocates.
+
+const std::uint32_t SNAPSHOT_MAGIC = 0x5353424e;	// "NBSS"
+const std::uint32_t SNAPSHOT_VERSION = 4;	// 2: the world's tick count, 3: its run hash, 4: the level schedule cursor
+
+struct WorldSnapshot
+{
+	std::vector<unsigned char> bytes;
+
+	bool writeFile(const std::string& path) const;	// false if the file couldn't be written
+	bool readFile(const std::string& path);	// false if it couldn't be read (bytes are then empty)
+};
+
+  // Appends plain values to a byte buffer
+
+class SnapshotWriter
+{
+public:
+	explicit SnapshotWriter(std::vector<unsigned char>& out)
+		: m_out(out)
+	{
+	}
+
+	template<typename T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+		m_out.insert(m_out.end(), p, p + sizeof(T));
+	}
+
+	template<typename T>
+	void writeArray(const T* values, std::uint32_t count)	// count, then the values
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+		write(count);
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(values);
+		m_out.insert(m_out.end(), p, p + count * sizeof(T));
+	}
+
+private:
+	std::vector<unsigned char>& m_out;
+};
+
+  // Reads back what a SnapshotWriter wrote. Reading past the end (or an array
+  // longer than the caller allows) zeroes the value and marks the reader failed;
+  // callers read everything and check failed() once at the end.
+
+class SnapshotReader
+{
+public:
+	SnapshotReader(const unsigned char* data, std::size_t size)
+		: m_data(data), m_size(size), m_pos(0), m_failed(false)
+	{
+	}
+
+	template<typename T>
+	T read()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+		T value;
+		if (m_failed || m_size - m_pos < sizeof(T))
+		{
+			m_failed = true;
+			std::memset(&value, 0, sizeof(T));
+			return value;
+		}
+		std::memcpy(&value, m_data + m_pos, sizeof(T));
+		m_pos += sizeof(T);
+		return value;
+	}
+
+	template<typename T>
+	void read(T& value)
+	{
+		value = read<T>();
+	}
+
+	template<typename T>
+	std::uint32_t readArray(T* values, std::uint32_t maxCount)	// returns the count; values needs room for maxCount
+	{
+		std::uint32_t count = read<std::uint32_t>();
+		if (count > maxCount || m_size - m_pos < count * sizeof(T))
+			m_failed = true;
+		if (m_failed)
+			return 0;
+		std::memcpy(values, m_data + m_pos, count * sizeof(T));
+		m_pos += count * sizeof(T);
+		return count;
+	}
+
+	template<typename T>
+	void readArray(std::vector<T>& values, std::uint32_t maxCount)
+	{
+		std::uint32_t count = read<std::uint32_t>();
+		if (count > maxCount || m_size - m_pos < count * sizeof(T))
+			m_failed = true;
+		if (m_failed)
+		{
+			values.clear();
+			return;
+		}
+		values.resize(count);
+		if (count > 0)
+			std::memcpy(values.data(), m_data + m_pos, count * sizeof(T));
+		m_pos += count * sizeof(T);
+	}
+
+	void fail()	// for callers that find a value they can't use
+	{
+		m_failed = true;
+	}
+
+	bool failed() const
+	{
+		return m_failed;
+	}
+
+	bool atEnd() const
+	{
+		return m_pos == m_size;
+	}
+
+private:
+	const unsigned char*	m_data;
+	std::size_t				m_size;
+	std::size_t				m_pos;
+	bool					m_failed;
+};
+
+#endif // WORLDSNAPSHOT_H_
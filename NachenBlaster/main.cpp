@@ -1,7 +1,27 @@
 #include "GameController.h"
+#include "HeadlessDriver.h"
+#include "StudentWorld.h"
+#include "TickProfiler.h"
+#include "CollisionKernel.h"
+#include "ThreadPool.h"
+#include "Replay.h"
+#include "LevelSchedule.h"
+#include "BatchRunner.h"
+#include "VecEnv.h"
+#include "InputSource.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
 using namespace std;
 
   // If your program is having trouble finding the Assets directory,
@@ -14,8 +34,570 @@ class GameWorld;
 
 GameWorld* createStudentWorld(string assetDir = "");
 
+  // the argument after flag, wherever it is on the command line, or nullptr
+static const char* argValue(int argc, char* argv[], const string& flag)
+{
+	for (int i = 1; i + 1 < argc; i++)
+		if (argv[i] == flag)
+			return argv[i + 1];
+	return nullptr;
+}
+
+  // -threads n anywhere on the command line: how many threads each tick may use (default 1)
+static unsigned int threadCountArg(int argc, char* argv[])
+{
+	const char* n = argValue(argc, argv, "-threads");
+	return (n != nullptr ? strtoul(n, nullptr, 10) : 1);
+}
+
+  // true if flag appears anywhere on the command line
+static bool hasFlag(int argc, char* argv[], const string& flag)
+{
+	for (int i = 1; i < argc; i++)
+		if (argv[i] == flag)
+			return true;
+	return false;
+}
+
+  // a 64 bit hash as 16 hex digits
+static string hashText(uint64_t hash)
+{
+	ostringstream oss;
+	oss << hex << setw(16) << setfill('0') << hash;
+	return oss.str();
+}
+
+  // -rewind mb anywhere on the command line: memory for the rewind buffer (0 turns it off)
+static size_t rewindBudgetArg(int argc, char* argv[])
+{
+	const char* mb = argValue(argc, argv, "-rewind");
+	return (mb != nullptr ? static_cast<size_t>(atof(mb) * (1 << 20)) : DEFAULT_REWIND_BYTES);
+}
+
+  // -levels file anywhere on the command line: map a compiled level file into levels and
+  // return it for the worlds to play (nullptr without the flag: random levels). A file that
+  // won't load is still returned, so the game stops with a level error.
+static const LevelSchedule* levelsArg(int argc, char* argv[], LevelSchedule& levels)
+{
+	const char* path = argValue(argc, argv, "-levels");
+	if (path == nullptr)
+		return nullptr;
+	if (!levels.open(path))
+		cout << "Cannot load levels from " << path << endl;
+	return &levels;
+}
+
+  // -input keyboard|bot|script:file|replay:file anywhere on the command line: where the
+  // ship's actions come from. keyboard (the default) is the keys, or headless, the random
+  // ones; replay:file is the same as -replay file, which is returned in replayPath. Returns
+  // the source to set (nullptr: the keys), or sets ok to false if the argument is no good.
+static InputSource* inputArg(int argc, char* argv[], ScriptedInput& script, BotInput& bot,
+							 const char*& replayPath, bool& ok)
+{
+	ok = true;
+	replayPath = argValue(argc, argv, "-replay");
+	const char* input = argValue(argc, argv, "-input");
+	if (input == nullptr || string(input) == "keyboard")
+		return nullptr;
+	if (string(input) == "bot")
+		return &bot;
+	if (string(input).compare(0, 7, "script:") == 0)
+	{
+		string error;
+		if (script.load(input + 7, error))
+			return &script;
+		cout << error << endl;
+	}
+	else if (string(input).compare(0, 7, "replay:") == 0)
+	{
+		replayPath = input + 7;
+		return nullptr;
+	}
+	else
+		cout << "Unknown input " << input << " (want keyboard, bot, script:file or replay:file)" << endl;
+	ok = false;
+	return nullptr;
+}
+
+  // NachenBlaster -headless -replay file [-seek tick] [-threads n] [-levels file]
+  // plays a recorded game back as fast as the CPU allows, starting from its
+  // keyframe at or before tick, and checks that it ends the way the recording did.
+  // A game recorded with -levels has to be played back with the same levels.
+
+static int runHeadlessReplay(int argc, char* argv[], const string& path)
+{
+	Replay replay;
+	if (!replay.load(path))
+	{
+		cout << "Cannot read replay " << path << endl;
+		return 1;
+	}
+	const char* seek = argValue(argc, argv, "-seek");
+	unsigned long seekTick = (seek != nullptr ? strtoul(seek, nullptr, 10) : 0);
+
+	ThreadPool pool(threadCountArg(argc, argv));
+	HeadlessDriver driver(assetDirectory);
+	driver.setThreadPool(&pool);
+	driver.setRewindBudget(rewindBudgetArg(argc, argv));
+	LevelSchedule levels;
+	driver.setLevels(levelsArg(argc, argv, levels));
+	HeadlessResult r = driver.playReplay(replay, seekTick);
+
+	cout << path << ": seed " << replay.getSeed() << ", " << replay.getTicks() << " ticks, "
+		 << replay.getActionCount() << " actions, " << replay.getKeyframeCount() << " keyframes" << endl;
+	if (seekTick > 0)
+		cout << "started at the keyframe for tick " << r.startTick << ", reached tick " << seekTick
+			 << " in " << r.seekSeconds * 1000 << " ms" << endl;
+	unsigned long ticks = r.ticks - r.startTick;
+	cout << ticks << " ticks in " << r.seconds << " s (" << (r.seconds > 0 ? ticks / r.seconds : 0)
+		 << " ticks/s) on " << pool.getThreadCount() << " thread(s): level " << r.level
+		 << ", score " << r.score << ", " << r.lives << " lives left, hash " << hashText(r.runHash) << endl;
+	bool same = (r.ticks == replay.getTicks() && r.score == replay.getScore() && r.lives == replay.getLives());
+	if (same)
+		cout << "matches the recording" << endl;
+	else
+		cout << "DOES NOT match the recording: " << replay.getTicks() << " ticks, score "
+			 << replay.getScore() << ", " << replay.getLives() << " lives left" << endl;
+	return (same ? 0 : 1);
+}
+
+  // NachenBlaster -headless [ticks] [seed] [-threads n] [-snapshots] [-record file] [-rewind mb] [-rewindcheck] [-hashlog file] [-levels file] [-input source]
+  // plays back-to-back games with no window until ticks have been simulated,
+  // with random keys, then reports the simulation rate. Game n uses world seed
+  // seed + n, so the same command line always plays the same games, with any
+  // number of threads. -snapshots saves and reloads the world after every tick,
+  // which mustn't change the games, and reports how long that took.
+  // -record plays just the first game and saves it as a replay. -rewindcheck
+  // rewinds to a recent tick every so often, checks the world is as it was
+  // then, and comes back (which mustn't change the games either). -hashlog
+  // writes the world's state hash after every tick, for -hashdiff. -levels
+  // plays the levels in a compiled level file instead of random ones. -input
+  // plays with a bot or a script instead of random keys (see inputArg).
+
+static int runHeadless(int argc, char* argv[])
+{
+	ScriptedInput script;
+	BotInput bot;
+	const char* replayPath;
+	bool inputOk;
+	InputSource* input = inputArg(argc, argv, script, bot, replayPath, inputOk);
+	if (!inputOk)
+		return 1;
+	if (replayPath != nullptr)
+		return runHeadlessReplay(argc, argv, replayPath);
+	const char* recordPath = argValue(argc, argv, "-record");
+	Replay recording;
+
+	unsigned long totalTicks = (argc > 2 && argv[2][0] != '-' ? strtoul(argv[2], nullptr, 10) : 100000);
+	unsigned long long seed = (argc > 3 && argv[3][0] != '-' ? strtoull(argv[3], nullptr, 10) : 1);
+
+	ThreadPool pool(threadCountArg(argc, argv));
+	HeadlessDriver driver(assetDirectory);
+	driver.setKeySource(HeadlessDriver::randomKeys(static_cast<unsigned int>(seed)));
+	driver.setThreadPool(&pool);
+	driver.setSnapshotEveryTick(hasFlag(argc, argv, "-snapshots"));
+	driver.setRewindBudget(rewindBudgetArg(argc, argv));
+	driver.setRewindCheck(hasFlag(argc, argv, "-rewindcheck"));
+	LevelSchedule levels;
+	driver.setLevels(levelsArg(argc, argv, levels));
+	driver.setInput(input);
+	ofstream hashLog;
+	const char* hashLogPath = argValue(argc, argv, "-hashlog");
+	if (hashLogPath != nullptr)
+	{
+		hashLog.open(hashLogPath);
+		if (!hashLog)
+		{
+			cout << "Cannot write " << hashLogPath << endl;
+			return 1;
+		}
+		driver.setHashLog(&hashLog);
+	}
+	if (recordPath != nullptr)
+		driver.setRecording(&recording);
+
+	unsigned long ticks = 0;
+	double seconds = 0;
+	int games = 0;
+	unsigned long long bruteForcePairs = 0, testedPairs = 0;
+	unsigned long snapshots = 0;
+	double snapshotSeconds = 0;
+	size_t snapshotBytes = 0;
+	unsigned long rewinds = 0;
+	double rewindSeconds = 0, rewindMaxSeconds = 0;
+	bool rewindFailed = false;
+	while (ticks < totalTicks)
+	{
+		HeadlessResult r = driver.runGame(totalTicks - ticks, seed + games);
+		ticks += r.ticks;
+		seconds += r.seconds;
+		games++;
+		bruteForcePairs += driver.getWorld()->getCollisionStats().bruteForcePairs;
+		testedPairs += driver.getWorld()->getCollisionStats().testedPairs;
+		snapshots += r.snapshots;
+		snapshotSeconds += r.snapshotSeconds;
+		snapshotBytes = r.snapshotBytes;
+		rewinds += r.rewinds;
+		rewindSeconds += r.rewindSeconds;
+		rewindMaxSeconds = max(rewindMaxSeconds, r.rewindMaxSeconds);
+		rewindFailed = rewindFailed || r.rewindFailed;
+		cout << "game " << games << ": " << r.ticks << " ticks, level " << r.level
+			 << ", score " << r.score << ", hash " << hashText(r.runHash);
+		if (r.status == GWSTATUS_PLAYER_WON)
+			cout << ", won";
+		else if (r.status == GWSTATUS_LEVEL_ERROR)
+			cout << ", level error";
+		cout << endl;
+		if (r.ticks == 0 || recordPath != nullptr)
+			break;
+	}
+	if (recordPath != nullptr)
+	{
+		if (!recording.save(recordPath))
+		{
+			cout << "Cannot write replay " << recordPath << endl;
+			return 1;
+		}
+		cout << "recorded " << recording.getActionCount() << " actions and " << recording.getKeyframeCount()
+			 << " keyframes to " << recordPath << endl;
+	}
+	cout << ticks << " ticks in " << seconds << " s (" << (seconds > 0 ? ticks / seconds : 0)
+		 << " ticks/s) over " << games << " games on " << pool.getThreadCount() << " thread(s)" << endl;
+	cout << "collision pairs: " << bruteForcePairs << " with all-pairs scans, "
+		 << testedPairs << " after broadphase" << endl;
+	if (snapshots > 0)
+		cout << "snapshots: " << snapshots << " saved and reloaded, " << snapshotSeconds * 1e6 / snapshots
+			 << " us each, last one " << snapshotBytes << " bytes" << endl;
+	if (rewinds > 0)
+		cout << "rewinds: " << rewinds << (rewindFailed ? " checked, SOME DIDN'T MATCH, " : " checked, ")
+			 << rewindSeconds * 1e6 / rewinds << " us each, slowest " << rewindMaxSeconds * 1e6 << " us" << endl;
+	if (driver.getWorld() != nullptr)
+	{
+		const RewindBuffer& buffer = driver.getWorld()->getRewindBuffer();
+		if (!buffer.empty())
+			cout << "rewind buffer in the last game: " << buffer.getNewestTick() - buffer.getOldestTick() + 1
+				 << " ticks in " << buffer.getBytes() / 1024 << " KB" << endl;
+		cout << "actor pools over all games (created / reused / peak live / capacity):" << endl;
+		for (const PoolStats& p : driver.getWorld()->getPoolStats())
+			cout << "  " << p.name << ": " << p.created << " / " << p.reused << " / "
+				 << p.peakLive << " / " << p.capacity << endl;
+	}
+#ifdef NB_PROFILE
+	driver.getProfiler().report(cout);
+#endif
+	return 0;
+}
+
+  // NachenBlaster -hashdiff a.log b.log
+  // compares two -hashlog files line by line ("seed tick hash") and reports
+  // the first tick where the runs went different ways
+
+static int runHashDiff(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		cout << "usage: NachenBlaster -hashdiff a.log b.log" << endl;
+		return 1;
+	}
+	ifstream a(argv[2]);
+	ifstream b(argv[3]);
+	if (!a || !b)
+	{
+		cout << "Cannot read " << (!a ? argv[2] : argv[3]) << endl;
+		return 1;
+	}
+	string lineA, lineB;
+	for (unsigned long n = 0; ; n++)
+	{
+		bool gotA = static_cast<bool>(getline(a, lineA));
+		bool gotB = static_cast<bool>(getline(b, lineB));
+		if (!gotA && !gotB)
+		{
+			cout << "the runs match for all " << n << " ticks" << endl;
+			return 0;
+		}
+		if (gotA != gotB)
+		{
+			cout << "the runs match for " << n << " ticks, then " << (gotA ? argv[3] : argv[2]) << " ends" << endl;
+			return 1;
+		}
+		if (lineA != lineB)
+		{
+			cout << "the runs match for " << n << " ticks, then (seed, tick, hash)" << endl;
+			cout << "  " << argv[2] << ": " << lineA << endl;
+			cout << "  " << argv[3] << ": " << lineB << endl;
+			return 1;
+		}
+	}
+}
+
+  // NachenBlaster -benchenv [worlds] [steps] [-threads n] [-levels file]
+  // steps a VecEnv of that many worlds with random actions, the way a training
+  // loop would, and reports steps per second and how many games ended
+
+static int runEnvBenchmark(int argc, char* argv[])
+{
+	unsigned int nWorlds = (argc > 2 && argv[2][0] != '-' ? strtoul(argv[2], nullptr, 10) : 64);
+	unsigned long nSteps = (argc > 3 && argv[3][0] != '-' ? strtoul(argv[3], nullptr, 10) : 10000);
+	if (nWorlds == 0)
+		nWorlds = 1;
+
+	VecEnv env(assetDirectory, nWorlds, threadCountArg(argc, argv));
+	LevelSchedule levels;
+	env.setLevels(levelsArg(argc, argv, levels));
+	vector<uint64_t> seeds(nWorlds);
+	for (unsigned int i = 0; i < nWorlds; i++)
+		seeds[i] = i + 1;
+	vector<NBObservation> observations(nWorlds);
+	vector<float> rewards(nWorlds);
+	vector<uint8_t> dones(nWorlds);
+	vector<int> actions(nWorlds);
+	minstd_rand generator(1);
+
+	env.reset(seeds.data(), observations.data());
+	unsigned long games = 0;
+	double reward = 0;
+	auto start = chrono::steady_clock::now();
+	for (unsigned long step = 0; step < nSteps; step++)
+	{
+		for (int& action : actions)
+			action = generator() % NB_NUM_ACTIONS;
+		env.step(actions.data(), observations.data(), rewards.data(), dones.data());
+		for (unsigned int i = 0; i < nWorlds; i++)
+		{
+			games += dones[i];
+			reward += rewards[i];
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << nSteps << " steps of " << nWorlds << " worlds in " << seconds << " s: "
+		 << (seconds > 0 ? nSteps / seconds : 0) << " steps/s, "
+		 << (seconds > 0 ? nSteps * nWorlds / seconds : 0) << " world ticks/s on "
+		 << threadCountArg(argc, argv) << " thread(s)" << endl;
+	cout << games << " games ended, total reward " << reward << "; observations are "
+		 << sizeof(NBObservation) << " bytes each" << endl;
+	return 0;
+}
+
+  // NachenBlaster -benchcollide [pairs]
+  // times each narrowphase kernel this CPU supports (and the old one-sqrt-per-pair
+  // test) on the same random blocks of candidates, and checks they agree
+
+static int runCollisionBenchmark(int argc, char* argv[])
+{
+	const unsigned int BLOCK = 16;	// candidates per query, about what a crowded grid neighbourhood holds
+	const unsigned int QUERIES = 4096;
+	unsigned long long pairs = (argc > 2 ? strtoull(argv[2], nullptr, 10) : 200000000);
+	unsigned long long rounds = pairs / (BLOCK * QUERIES) + 1;
+
+	minstd_rand gen(1);
+	uniform_real_distribution<double> coord(0, VIEW_WIDTH);
+	uniform_int_distribution<int> size(1, 4);	// radii of .5, 1, 1.5 and 2 sizes, like the real actors
+	vector<double> qx(QUERIES), qy(QUERIES), qr(QUERIES);
+	vector<double> xs(QUERIES * BLOCK), ys(QUERIES * BLOCK), radii(QUERIES * BLOCK);
+	for (unsigned int q = 0; q < QUERIES; q++)
+	{
+		qx[q] = coord(gen);
+		qy[q] = coord(gen);
+		qr[q] = 4.0 * size(gen);
+		for (unsigned int j = 0; j < BLOCK; j++)	// cluster each block around its query so some of them hit
+		{
+			xs[q * BLOCK + j] = qx[q] + (coord(gen) - VIEW_WIDTH / 2) / 2;
+			ys[q * BLOCK + j] = qy[q] + (coord(gen) - VIEW_HEIGHT / 2) / 2;
+			radii[q * BLOCK + j] = 4.0 * size(gen);
+		}
+	}
+	vector<unsigned int> hits(BLOCK);
+
+	auto time = [&](const char* name, OverlapFunc f)
+	{
+		unsigned long long nHits = 0;
+		auto start = chrono::steady_clock::now();
+		for (unsigned long long r = 0; r < rounds; r++)
+			for (unsigned int q = 0; q < QUERIES; q++)
+				nHits += f(qx[q], qy[q], qr[q], &xs[q * BLOCK], &ys[q * BLOCK], &radii[q * BLOCK], BLOCK, hits.data());
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+		unsigned long long tested = rounds * QUERIES * BLOCK;
+		cout << name << ": " << tested << " pairs in " << elapsed.count() << " s ("
+			 << tested / elapsed.count() / 1e6 << " M pairs/s), " << nHits << " hits" << endl;
+	};
+
+	time("sqrt", [](double x, double y, double radius, const double* xs, const double* ys, const double* radii,
+					unsigned int n, unsigned int* hits)
+	{
+		unsigned int nHits = 0;
+		for (unsigned int i = 0; i < n; i++)
+			if (sqrt((xs[i] - x) * (xs[i] - x) + (ys[i] - y) * (ys[i] - y)) < .75 * (radius + radii[i]))
+				hits[nHits++] = i;
+		return nHits;
+	});
+	for (int kind = 0; kind < NUM_COLLISION_KERNELS; kind++)
+	{
+		CollisionKernelKind k = static_cast<CollisionKernelKind>(kind);
+		if (collisionKernelSupported(k))
+			time(collisionKernelName(k), getOverlapFunc(k));
+		else
+			cout << collisionKernelName(k) << ": not supported here" << endl;
+	}
+	cout << "the game uses " << collisionKernelName(bestCollisionKernel()) << endl;
+	return 0;
+}
+
+  // -seeds list: seeds separated by commas, each either one seed or a range a-b; false if it doesn't parse
+static bool parseSeeds(const string& list, vector<uint64_t>& seeds)
+{
+	istringstream in(list);
+	string item;
+	while (getline(in, item, ','))
+	{
+		char* end;
+		uint64_t first = strtoull(item.c_str(), &end, 10);
+		uint64_t last = first;
+		if (end == item.c_str())
+			return false;
+		if (*end == '-')
+		{
+			const char* from = end + 1;
+			last = strtoull(from, &end, 10);
+			if (end == from || last < first)
+				return false;
+		}
+		if (*end != '\0')
+			return false;
+		for (uint64_t seed = first; seed <= last && seed >= first; seed++)
+			seeds.push_back(seed);
+	}
+	return !seeds.empty();
+}
+
+  // NachenBlaster -batch [-seeds 1-100] [-workers n] [-maxticks n] [-keys random|none] [-input bot|script:file] [-levels file] [-out results.csv]
+  // plays one game per seed, each to the end (or n ticks), spread over n worker
+  // threads (default: one per core), then reports the throughput of the whole
+  // batch. Each game's keys depend only on its seed, so the results don't depend
+  // on the number of workers. -input plays every game with a bot or a script
+  // instead of the keys. -out writes one line per game, in seed order.
+
+static int runBatch(int argc, char* argv[])
+{
+	const char* seedList = argValue(argc, argv, "-seeds");
+	vector<uint64_t> seeds;
+	if (!parseSeeds(seedList != nullptr ? seedList : "1-100", seeds))
+	{
+		cout << "Bad seed list " << seedList << " (want something like 1-100 or 3,7,20-29)" << endl;
+		return 1;
+	}
+	const char* workers = argValue(argc, argv, "-workers");
+	unsigned int nWorkers = (workers != nullptr ? strtoul(workers, nullptr, 10) : thread::hardware_concurrency());
+
+	BatchRunner batch(assetDirectory, nWorkers > 0 ? nWorkers : 1);
+	const char* maxTicks = argValue(argc, argv, "-maxticks");
+	if (maxTicks != nullptr)
+		batch.setMaxTicks(strtoul(maxTicks, nullptr, 10));
+	const char* keys = argValue(argc, argv, "-keys");
+	if (keys != nullptr && string(keys) == "none")
+		batch.setKeySource([](uint64_t) { return HeadlessDriver::KeySource(); });
+	else if (keys != nullptr && string(keys) != "random")
+	{
+		cout << "Unknown key source " << keys << " (want random or none)" << endl;
+		return 1;
+	}
+	ScriptedInput script;
+	BotInput bot;
+	const char* replayPath;
+	bool inputOk;
+	batch.setInput(inputArg(argc, argv, script, bot, replayPath, inputOk));
+	if (!inputOk)
+		return 1;
+	if (replayPath != nullptr)
+	{
+		cout << "A batch can't play a replay; use -headless -replay" << endl;
+		return 1;
+	}
+	LevelSchedule levels;
+	batch.setLevels(levelsArg(argc, argv, levels));
+	ofstream out;
+	const char* outPath = argValue(argc, argv, "-out");
+	if (outPath != nullptr)
+	{
+		out.open(outPath);
+		if (!out)
+		{
+			cout << "Cannot write " << outPath << endl;
+			return 1;
+		}
+	}
+
+	vector<BatchGame> games = batch.run(seeds);
+
+	if (out.is_open())
+		out << "seed,worker,score,level,ticks,seconds,ticks_per_second,won,hash" << endl;
+	unsigned long long ticks = 0, score = 0;
+	double seconds = 0;
+	int won = 0;
+	for (const BatchGame& g : games)
+	{
+		const HeadlessResult& r = g.result;
+		ticks += r.ticks;
+		score += r.score;
+		seconds += r.seconds;
+		won += (r.status == GWSTATUS_PLAYER_WON);
+		if (out.is_open())
+			out << g.seed << ',' << g.worker << ',' << r.score << ',' << r.level << ',' << r.ticks << ','
+				<< r.seconds << ',' << (r.seconds > 0 ? r.ticks / r.seconds : 0) << ','
+				<< (r.status == GWSTATUS_PLAYER_WON) << ',' << hashText(r.runHash) << '\n';
+	}
+	double wall = batch.getWallSeconds();
+	cout << games.size() << " games, " << ticks << " ticks in " << wall << " s on "
+		 << batch.getWorkerCount() << " worker(s): " << (wall > 0 ? ticks / wall : 0) << " ticks/s, "
+		 << (wall > 0 ? games.size() / wall : 0) << " games/s" << endl;
+	cout << "per worker: " << (seconds > 0 ? ticks / seconds : 0) << " ticks/s while playing; mean score "
+		 << (games.empty() ? 0 : static_cast<double>(score) / games.size()) << ", " << won << " won" << endl;
+	if (out.is_open())
+		cout << "wrote " << games.size() << " results to " << outPath << endl;
+	return 0;
+}
+
+  // NachenBlaster -compilelevels levels.txt levels.nbl
+  // compiles a text level file into the binary one -levels plays (see LevelSchedule.h)
+
+static int runCompileLevels(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		cout << "usage: NachenBlaster -compilelevels levels.txt levels.nbl" << endl;
+		return 1;
+	}
+	string error;
+	if (!compileLevels(argv[2], argv[3], error))
+	{
+		cout << error << endl;
+		return 1;
+	}
+	LevelSchedule levels;
+	if (!levels.open(argv[3]))	// can't happen unless compiling and loading disagree
+	{
+		cout << "Cannot load " << argv[3] << " back" << endl;
+		return 1;
+	}
+	cout << "compiled " << levels.getLevelCount() << " levels into " << argv[3] << endl;
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
+	if (argc > 1 && string(argv[1]) == "-headless")
+		return runHeadless(argc, argv);
+	if (argc > 1 && string(argv[1]) == "-benchcollide")
+		return runCollisionBenchmark(argc, argv);
+	if (argc > 1 && string(argv[1]) == "-hashdiff")
+		return runHashDiff(argc, argv);
+	if (argc > 1 && string(argv[1]) == "-compilelevels")
+		return runCompileLevels(argc, argv);
+	if (argc > 1 && string(argv[1]) == "-benchenv")
+		return runEnvBenchmark(argc, argv);
+	if (argc > 1 && string(argv[1]) == "-batch")
+		return runBatch(argc, argv);
+
 	{
 		string path = assetDirectory;
 		if (!path.empty())
@@ -30,6 +612,70 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	GameWorld* gw = createStudentWorld(assetDirectory);
-	Game().run(argc, argv, gw, "NachenBlaster");
+	GameController game;
+
+	  // -tickrate n sets how many times a second the game advances,
+	  // -fps n how often the screen is redrawn (in between, positions are interpolated)
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "-tickrate")
+			game.setTickRate(atof(argv[i + 1]));
+		else if (arg == "-fps")
+			game.setFrameRate(atof(argv[i + 1]));
+	}
+
+	  // -record file saves the game as a replay when the window closes;
+	  // -replay file [-seek tick] watches one in real time, from its keyframe at or before tick;
+	  // -input bot or -input script:file plays by itself (see inputArg)
+	const char* recordPath = argValue(argc, argv, "-record");
+	ScriptedInput script;
+	BotInput bot;
+	const char* replayPath;
+	bool inputOk;
+	InputSource* input = inputArg(argc, argv, script, bot, replayPath, inputOk);
+	if (!inputOk)
+		return 1;
+	Replay replay;
+	StudentWorld* sw;
+	if (replayPath != nullptr)
+	{
+		if (!replay.load(replayPath))
+		{
+			cout << "Cannot read replay " << replayPath << endl;
+			return 1;
+		}
+		const char* seek = argValue(argc, argv, "-seek");
+		sw = new StudentWorld(assetDirectory, replay.getSeed());
+		sw->setPlayback(&replay, seek != nullptr ? strtoul(seek, nullptr, 10) : 0);
+		game.setAutoContinue(true);	// nobody is there to press Enter
+	}
+	else
+	{
+		sw = static_cast<StudentWorld*>(createStudentWorld(assetDirectory));	// createStudentWorld always makes a StudentWorld
+		if (recordPath != nullptr)
+			sw->setRecording(&replay);
+	}
+
+	  // -levels file plays the levels in a compiled level file
+	LevelSchedule levels;
+	sw->setLevels(levelsArg(argc, argv, levels));
+	sw->setInput(input);
+	if (input != nullptr)
+		game.setAutoContinue(true);	// the bot or script can't press Enter either
+
+	ThreadPool pool(threadCountArg(argc, argv));
+	sw->setThreadPool(&pool);
+	sw->setRewindBudget(rewindBudgetArg(argc, argv));
+	game.run(argc, argv, sw, "NachenBlaster");	// deletes the world when the window closes
+
+	if (replayPath == nullptr && recordPath != nullptr)
+	{
+		if (!replay.save(recordPath))
+		{
+			cout << "Cannot write replay " << recordPath << endl;
+			return 1;
+		}
+		cout << "recorded " << replay.getTicks() << " ticks to " << recordPath << endl;
+	}
 }